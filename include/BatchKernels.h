@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+
+// Ядра пакетного вычисления значений полинома в массиве точек. Для блока
+// точек заранее вычислены строки степеней координат (строка - степень одной
+// переменной во всех точках блока), и моном добавляет в результат по каждой
+// точке произведение своего коэффициента на свои строки. Внутренний цикл идет
+// по точкам, поэтому обрабатывает сразу 8 (AVX-512) или 4 (AVX2 + FMA)
+// значения double; без этих наборов инструкций работает скалярный цикл.
+//
+// GCC и Clang на x86 собирают векторные ядра всегда (атрибут target, без
+// флагов -mavx2 у всей сборки), а ядро выбирается один раз во время выполнения
+// по возможностям процессора. Другие компиляторы (MSVC) собирают только ядра,
+// разрешенные флагами сборки (/arch:AVX2, /arch:AVX512).
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_KERNELS_DISPATCH
+#define BATCH_KERNELS_AVX2
+#define BATCH_KERNELS_AVX512
+#define BATCH_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#if defined(__AVX2__)
+#define BATCH_KERNELS_AVX2
+#endif
+#if defined(__AVX512F__)
+#define BATCH_KERNELS_AVX512
+#endif
+#define BATCH_KERNEL_TARGET(isa)
+#endif
+
+#if defined(BATCH_KERNELS_AVX2) || defined(BATCH_KERNELS_AVX512)
+#include <immintrin.h>
+#endif
+
+// Набор инструкций ядра для double
+enum class BatchKernel {
+    Scalar,
+    Avx2,   // AVX2 и FMA
+    Avx512  // AVX-512F
+};
+
+// out[j] += coeff * rows[0][j] * ... * rows[vars - 1][j] для j < n
+template<class T>
+inline void accumulateTerm(T coeff, const T* const* rows, int vars, T* out, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        T value = coeff;
+        for (int k = 0; k < vars; ++k) {
+            value = value * rows[k][j];
+        }
+        out[j] += value;
+    }
+}
+
+// Скалярный цикл для double по точкам [begin, n)
+inline void accumulateTermScalar(double coeff, const double* const* rows, int vars, double* out, size_t begin, size_t n) {
+    for (size_t j = begin; j < n; ++j) {
+        double value = coeff;
+        for (int k = 0; k < vars; ++k) {
+            value *= rows[k][j];
+        }
+        out[j] += value;
+    }
+}
+
+#if defined(BATCH_KERNELS_AVX2)
+// Последняя строка умножается вместе со сложением
+BATCH_KERNEL_TARGET("avx2,fma")
+inline void accumulateTermAvx2(double coeff, const double* const* rows, int vars, double* out, size_t n) {
+    const int last = vars - 1;
+    const __m256d coeff4 = _mm256_set1_pd(coeff);
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d value = coeff4;
+        for (int k = 0; k < last; ++k) {
+            value = _mm256_mul_pd(value, _mm256_loadu_pd(rows[k] + j));
+        }
+        __m256d sum = _mm256_fmadd_pd(value, _mm256_loadu_pd(rows[last] + j), _mm256_loadu_pd(out + j));
+        _mm256_storeu_pd(out + j, sum);
+    }
+    accumulateTermScalar(coeff, rows, vars, out, j, n);
+}
+#endif
+
+#if defined(BATCH_KERNELS_AVX512)
+// Остаток блока (меньше 8 точек) обрабатывается той же инструкцией по маске
+BATCH_KERNEL_TARGET("avx512f")
+inline void accumulateTermAvx512(double coeff, const double* const* rows, int vars, double* out, size_t n) {
+    const int last = vars - 1;
+    const __m512d coeff8 = _mm512_set1_pd(coeff);
+    for (size_t j = 0; j < n; j += 8) {
+        const __mmask8 mask = n - j >= 8 ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << (n - j)) - 1);
+        __m512d value = coeff8;
+        for (int k = 0; k < last; ++k) {
+            value = _mm512_mul_pd(value, _mm512_maskz_loadu_pd(mask, rows[k] + j));
+        }
+        __m512d sum = _mm512_fmadd_pd(value, _mm512_maskz_loadu_pd(mask, rows[last] + j), _mm512_maskz_loadu_pd(mask, out + j));
+        _mm512_mask_storeu_pd(out + j, mask, sum);
+    }
+}
+#endif
+
+// Может ли ядро работать на этом процессоре (и собрано ли оно)
+inline bool isBatchKernelSupported(BatchKernel kernel) {
+    switch (kernel) {
+    case BatchKernel::Avx512:
+#if defined(BATCH_KERNELS_DISPATCH)
+        return __builtin_cpu_supports("avx512f");
+#elif defined(BATCH_KERNELS_AVX512)
+        return true;
+#else
+        return false;
+#endif
+    case BatchKernel::Avx2:
+#if defined(BATCH_KERNELS_DISPATCH)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(BATCH_KERNELS_AVX2)
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+// Самое широкое доступное ядро; определяется при первом вызове
+inline BatchKernel bestBatchKernel() {
+    static const BatchKernel best = isBatchKernelSupported(BatchKernel::Avx512) ? BatchKernel::Avx512
+        : isBatchKernelSupported(BatchKernel::Avx2) ? BatchKernel::Avx2 : BatchKernel::Scalar;
+    return best;
+}
+
+// Вычисление заданным ядром; ядро должно поддерживаться (isBatchKernelSupported)
+inline void accumulateTerm(BatchKernel kernel, double coeff, const double* const* rows, int vars, double* out, size_t n) {
+    switch (kernel) {
+#if defined(BATCH_KERNELS_AVX512)
+    case BatchKernel::Avx512:
+        accumulateTermAvx512(coeff, rows, vars, out, n);
+        return;
+#endif
+#if defined(BATCH_KERNELS_AVX2)
+    case BatchKernel::Avx2:
+        accumulateTermAvx2(coeff, rows, vars, out, n);
+        return;
+#endif
+    default:
+        accumulateTermScalar(coeff, rows, vars, out, 0, n);
+    }
+}
+
+inline void accumulateTerm(double coeff, const double* const* rows, int vars, double* out, size_t n) {
+    accumulateTerm(bestBatchKernel(), coeff, rows, vars, out, n);
+}
@@ -132,7 +132,48 @@ public:
     }
     ~ChainHashTable() = default;
 
+    ChainHashTable(const ChainHashTable& other) = default;
+    ChainHashTable& operator=(const ChainHashTable& other) = default;
+
+    // После перемещения исходная таблица остается пустой, но рабочей
+    ChainHashTable(ChainHashTable&& other)
+        : table(std::move(other.table)), capacity(other.capacity), num_elements(other.num_elements), hasher()
+    {
+        other.table.clear();
+        other.table.resize(other.capacity);
+        other.num_elements = 0;
+    }
+
+    ChainHashTable& operator=(ChainHashTable&& other) {
+        if (this != &other) {
+            table = std::move(other.table);
+            capacity = other.capacity;
+            num_elements = other.num_elements;
+            other.table.clear();
+            other.table.resize(other.capacity);
+            other.num_elements = 0;
+        }
+        return *this;
+    }
+
     iterator insert(const K& key, const V& value) {
+        return insertValue(key, value);
+    }
+
+    iterator insert(const K& key, V&& value) {
+        return insertValue(key, std::move(value));
+    }
+
+    // Значение строится из args и перемещается в таблицу без копирования
+    template<class... Args>
+    iterator emplace(const K& key, Args&&... args) {
+        return insertValue(key, V(std::forward<Args>(args)...));
+    }
+
+private:
+    // Значение копируется или перемещается в корзину в зависимости от категории аргумента
+    template<class TArg>
+    iterator insertValue(const K& key, TArg&& value) {
         size_t index = hash_index(key); 
         auto& bucket = table[index];    
 
@@ -141,12 +182,14 @@ public:
                 throw "the element with this key already exists";
             }
         }
-        bucket.push_back({ key, value });
+        bucket.emplace_back(key, std::forward<TArg>(value));
         num_elements++; 
         auto inserted_it = --bucket.end();
         return iterator(this, index, inserted_it);
     }
 
+public:
+
     iterator find(const K& key) {
         if (empty()) return end(); 
 
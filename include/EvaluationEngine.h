@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "polynomial.h"
+#include "ThreadPool.h"
+
+// Размер строки кэша: границы частей результата выравниваются по нему, чтобы
+// два потока никогда не писали в одну строку
+const size_t CACHE_LINE_SIZE = 64;
+
+// Объем данных одной части (координаты и результаты ее точек): половина
+// типичного L2 на ядро (256 КБ), остальное - таблицы степеней и сам полином
+const size_t EVALUATION_CHUNK_BYTES = 128 * 1024;
+
+// Параллельное вычисление значений полинома в большом наборе точек. Точки
+// делятся на части, каждая из которых вычисляется evaluateBatch в одном потоке
+// пула с перехватом работы. Часть помещается в L2, а ее границы в массиве
+// результатов (кроме краев массива) выровнены по строке кэша, поэтому потоки
+// не делят строки результата (нет ложного разделения).
+class EvaluationEngine {
+private:
+    ThreadPool& pool;
+    size_t chunk_bytes;
+
+public:
+    explicit EvaluationEngine(ThreadPool& thread_pool, size_t bytes_per_chunk = EVALUATION_CHUNK_BYTES)
+        : pool(thread_pool), chunk_bytes(bytes_per_chunk) {}
+
+    // Число точек в части: координаты VARIABLES переменных и результат,
+    // кратно числу значений в строке кэша
+    template<class TCoeff, int VARIABLES>
+    size_t chunkPoints() const {
+        const size_t line_values = std::max<size_t>(1, CACHE_LINE_SIZE / sizeof(TCoeff));
+        size_t points = chunk_bytes / ((VARIABLES + 1) * sizeof(TCoeff));
+        return std::max(line_values, points / line_values * line_values);
+    }
+
+    // coords[var][j] - координата var точки j, результат в out[j]
+    template<class TCoeff, class TLayout>
+    void evaluate(const TPolynomial<TCoeff, TLayout>& poly,
+        const std::array<const TCoeff*, TLayout::VARIABLES>& coords, TCoeff* out, size_t n) const {
+        if (n == 0) return;
+        // Нормализуем заранее, чтобы потоки только читали полином
+        poly.getTerms();
+
+        const size_t chunk = chunkPoints<TCoeff, TLayout::VARIABLES>();
+        // Первая часть короче, если out не выровнен: тогда начала остальных
+        // частей попадают на границы строк кэша
+        size_t head = 0;
+        if (CACHE_LINE_SIZE % sizeof(TCoeff) == 0) {
+            size_t misalignment = reinterpret_cast<uintptr_t>(out) % CACHE_LINE_SIZE;
+            if (misalignment % sizeof(TCoeff) == 0 && misalignment != 0) {
+                head = (CACHE_LINE_SIZE - misalignment) / sizeof(TCoeff);
+            }
+        }
+        head = std::min(head, n);
+        const size_t chunks = (head > 0 ? 1 : 0) + (n - head + chunk - 1) / chunk;
+
+        pool.parallelFor(chunks, [&](size_t index) {
+            size_t begin = 0, end = head;
+            if (head == 0 || index > 0) {
+                size_t k = head > 0 ? index - 1 : index;
+                begin = head + k * chunk;
+                end = std::min(n, begin + chunk);
+            }
+            std::array<const TCoeff*, TLayout::VARIABLES> part;
+            for (int var = 0; var < TLayout::VARIABLES; ++var) {
+                part[var] = coords[var] + begin;
+            }
+            poly.evaluateBatch(part, out + begin, end - begin);
+        });
+    }
+
+    // Точки (xs[j], ys[j], zs[j]) для раскладок не более чем с тремя переменными
+    template<class TCoeff, class TLayout>
+    void evaluate(const TPolynomial<TCoeff, TLayout>& poly,
+        const TCoeff* xs, const TCoeff* ys, const TCoeff* zs, TCoeff* out, size_t n) const {
+        static_assert(TLayout::VARIABLES <= 3, "Для раскладок с большим числом переменных координаты передаются массивом");
+        const TCoeff* all[3] = { xs, ys, zs };
+        std::array<const TCoeff*, TLayout::VARIABLES> coords;
+        std::copy(all, all + TLayout::VARIABLES, coords.begin());
+        evaluate(poly, coords, out, n);
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+// Быстрое преобразование Фурье для свертки вещественных последовательностей.
+// Используется умножением полиномов высокой степени: после подстановки
+// Кронекера (ключ монома - показатель степени одной переменной) произведение
+// полиномов - это свертка их коэффициентов.
+
+// Наименьшая степень двойки, не меньшая n
+inline size_t fftLength(size_t n) {
+    size_t length = 1;
+    while (length < n) {
+        length <<= 1;
+    }
+    return length;
+}
+
+// Итеративное БПФ по основанию 2 на месте; длина a - степень двойки.
+// При inverse == true выполняется обратное преобразование (с делением на длину).
+inline void fft(std::vector<std::complex<double>>& a, bool inverse) {
+    const size_t n = a.size();
+    if (n <= 1) return;
+
+    // Перестановка с обращением битов индекса
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    // Поворотные множители считаются один раз для самого длинного этапа;
+    // этап длины len берет каждый (n / len)-й из них
+    const double pi = std::acos(-1.0);
+    std::vector<std::complex<double>> roots(n / 2);
+    for (size_t k = 0; k < n / 2; ++k) {
+        double angle = 2 * pi * k / n * (inverse ? -1 : 1);
+        roots[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2, step = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<double> u = a[i + k];
+                std::complex<double> v = a[i + k + half] * roots[k * step];
+                a[i + k] = u + v;
+                a[i + k + half] = u - v;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (auto& value : a) {
+            value /= static_cast<double>(n);
+        }
+    }
+}
+
+// Свертка вещественных последовательностей: result[k] = sum a[i] * b[k - i],
+// длина результата a.size() + b.size() - 1. Обе последовательности упакованы
+// в одну комплексную (a - вещественная часть, b - мнимая), поэтому нужно
+// два преобразования вместо трех.
+inline std::vector<double> convolve(const std::vector<double>& a, const std::vector<double>& b) {
+    if (a.empty() || b.empty()) {
+        return std::vector<double>();
+    }
+    const size_t result_size = a.size() + b.size() - 1;
+    const size_t n = fftLength(result_size);
+
+    std::vector<std::complex<double>> z(n);
+    for (size_t i = 0; i < a.size(); ++i) {
+        z[i].real(a[i]);
+    }
+    for (size_t i = 0; i < b.size(); ++i) {
+        z[i].imag(b[i]);
+    }
+    fft(z, false);
+
+    // Z = A + iB, где A и B - спектры вещественных a и b, поэтому
+    // A[k] * B[k] = (Z[k]^2 - conj(Z[-k])^2) / 4i
+    std::vector<std::complex<double>> product(n);
+    for (size_t k = 0; k < n; ++k) {
+        std::complex<double> zk = z[k];
+        std::complex<double> zr = std::conj(z[(n - k) & (n - 1)]);
+        product[k] = (zk * zk - zr * zr) * std::complex<double>(0, -0.25);
+    }
+    fft(product, true);
+
+    std::vector<double> result(result_size);
+    for (size_t i = 0; i < result_size; ++i) {
+        result[i] = product[i].real();
+    }
+    return result;
+}
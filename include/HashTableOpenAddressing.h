@@ -37,12 +37,12 @@ private:
 
         capacity = (capacity == 0) ? 16 : capacity * 2;
 
-        table.assign(capacity, Slot());
+        table.resize(capacity);
         current_size = 0;
 
         for (size_t i = 0; i < old_capacity; ++i) {
             if (old_table[i].state == SlotState::OCCUPIED) {
-                insert(old_table[i].data.first, old_table[i].data.second);
+                insert(old_table[i].data.first, std::move(old_table[i].data.second));
             }
         }
     }
@@ -132,6 +132,28 @@ public:
         return *this;
     }
 
+    // После перемещения исходная таблица имеет нулевую емкость и пересоздается при вставке
+    HashTableOpenAddressing(HashTableOpenAddressing&& other) noexcept
+        : table(std::move(other.table)), current_size(other.current_size), capacity(other.capacity), hasher(other.hasher) {
+        other.table.clear();
+        other.current_size = 0;
+        other.capacity = 0;
+    }
+
+    HashTableOpenAddressing& operator=(HashTableOpenAddressing&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        table = std::move(other.table);
+        current_size = other.current_size;
+        capacity = other.capacity;
+        hasher = other.hasher;
+        other.table.clear();
+        other.current_size = 0;
+        other.capacity = 0;
+        return *this;
+    }
+
     iterator begin() {
         return iterator(table.begin(), table.end());
     }
@@ -141,6 +163,23 @@ public:
     }
 
     bool insert(const TKey& key, const TValue& value) {
+        return insertValue(key, value);
+    }
+
+    bool insert(const TKey& key, TValue&& value) {
+        return insertValue(key, std::move(value));
+    }
+
+    // Значение строится из args и перемещается в таблицу без копирования
+    template<class... Args>
+    bool emplace(const TKey& key, Args&&... args) {
+        return insertValue(key, TValue(std::forward<Args>(args)...));
+    }
+
+private:
+    // Значение копируется или перемещается в слот в зависимости от категории аргумента
+    template<class V>
+    bool insertValue(const TKey& key, V&& value) {
         if (capacity == 0 || (double)(current_size + 1) / capacity >= MAX_LOAD_FACTOR) { 
             rehash();
         }
@@ -153,14 +192,15 @@ public:
 
             if (table[index].state == SlotState::OCCUPIED) {
                 if (table[index].data.first == key) {
-                    table[index].data.second = value;
+                    table[index].data.second = std::forward<V>(value);
                     return false;
                 }
             }
             else if (table[index].state == SlotState::EMPTY) {
                 size_t insert_idx = (first_deleted_index != static_cast<size_t>(-1)) ? first_deleted_index : index;
 
-                table[insert_idx].data = std::make_pair(key, value);
+                table[insert_idx].data.first = key;
+                table[insert_idx].data.second = std::forward<V>(value);
                 table[insert_idx].state = SlotState::OCCUPIED;
                 current_size++;
                 return true;
@@ -174,15 +214,18 @@ public:
         }
 
         if (first_deleted_index != static_cast<size_t>(-1)) {
-            table[first_deleted_index].data = std::make_pair(key, value);
+            table[first_deleted_index].data.first = key;
+            table[first_deleted_index].data.second = std::forward<V>(value);
             table[first_deleted_index].state = SlotState::OCCUPIED;
             current_size++;
             return true;
         }
         rehash(); 
-        return insert(key, value); 
+        return insertValue(key, std::forward<V>(value)); 
     }
 
+public:
+
     TValue* find(const TKey& key) {
         size_t attempt = 0;
         while (attempt < capacity) {
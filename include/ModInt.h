@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+// Наибольшее простое число, меньшее 2^64
+const uint64_t DEFAULT_MODULUS = 0xFFFFFFFFFFFFFFC5ULL;
+
+// Вычет по простому модулю P < 2^64. Значение всегда лежит в [0, P),
+// сравнение точное.
+template<uint64_t P = DEFAULT_MODULUS>
+class ModInt {
+private:
+    uint64_t val;
+
+    static uint64_t mulMod(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % P);
+#else
+        // Умножение сложением с удвоением: без 128-битного типа
+        uint64_t result = 0;
+        a %= P;
+        while (b > 0) {
+            if (b & 1) {
+                result = addMod(result, a);
+            }
+            a = addMod(a, a);
+            b >>= 1;
+        }
+        return result;
+#endif
+    }
+
+    static uint64_t addMod(uint64_t a, uint64_t b) {
+        return a >= P - b ? a - (P - b) : a + b;
+    }
+
+public:
+    static const uint64_t modulus = P;
+
+    ModInt() : val(0) {}
+
+    // Из любого целого; отрицательные числа приводятся к вычету P - |v| mod P
+    template<class TInt, typename std::enable_if<std::is_integral<TInt>::value, int>::type = 0>
+    ModInt(TInt v) {
+        if (v >= 0) {
+            val = static_cast<uint64_t>(v) % P;
+        }
+        else {
+            uint64_t magnitude = (static_cast<uint64_t>(-(v + 1)) + 1) % P;
+            val = magnitude == 0 ? 0 : P - magnitude;
+        }
+    }
+
+    uint64_t value() const {
+        return val;
+    }
+
+    ModInt& operator+=(const ModInt& other) {
+        val = addMod(val, other.val);
+        return *this;
+    }
+
+    ModInt& operator-=(const ModInt& other) {
+        val = val >= other.val ? val - other.val : P - (other.val - val);
+        return *this;
+    }
+
+    ModInt& operator*=(const ModInt& other) {
+        val = mulMod(val, other.val);
+        return *this;
+    }
+
+    ModInt operator+(const ModInt& other) const { return ModInt(*this) += other; }
+    ModInt operator-(const ModInt& other) const { return ModInt(*this) -= other; }
+    ModInt operator*(const ModInt& other) const { return ModInt(*this) *= other; }
+
+    ModInt operator-() const {
+        return ModInt() - *this;
+    }
+
+    bool operator==(const ModInt& other) const { return val == other.val; }
+    bool operator!=(const ModInt& other) const { return val != other.val; }
+
+    friend std::ostream& operator<<(std::ostream& ostr, const ModInt& m) {
+        return ostr << m.val;
+    }
+};
@@ -14,7 +14,7 @@
 #include "polynomial.h" // Нужен для Monomial, Polynomial, MIN/MAX_DEGREE, EPSILON
 
 // Вспомогательная функция для удаления пробелов по краям строки
-std::string trim(const std::string& str) {
+inline std::string trim(const std::string& str) {
     size_t first = str.find_first_not_of(" \t");
     if (std::string::npos == first) {
         return "";
@@ -23,20 +23,33 @@ std::string trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
+// Номер переменной раскладки TLayout, обозначенной символом c, или -1
+template<class TLayout>
+int variableIndex(char c) {
+    for (int var = 0; var < TLayout::VARIABLES; ++var) {
+        if (VARIABLE_NAMES[var] == c) return var;
+    }
+    return -1;
+}
+
 // Функция для парсинга одного члена полинома (монома)
-// Возвращает Monomial. Может выбрасывать исключения std::runtime_error или std::out_of_range.
-Monomial parseTerm(const std::string& term_str) {
+// Возвращает моном с коэффициентом типа TCoeff (по умолчанию double). Для точных
+// типов (int64_t, ModInt) коэффициент должен быть целым числом. Переменные -
+// первые TLayout::VARIABLES букв из VARIABLE_NAMES (по умолчанию x, y, z).
+// Может выбрасывать исключения std::runtime_error или std::out_of_range.
+template<class TCoeff = double, class TLayout = DefaultLayout>
+TMonomial<TCoeff, TLayout> parseTerm(const std::string& term_str) {
     std::string s = trim(term_str);
     if (s.empty()) {
         // Пустая строка после trim - ошибка формата на этом этапе
         throw std::runtime_error("Ошибка парсинга члена: Пустая строка монома после знака/trim.");
     }
 
-    double sign_multiplier = 1.0;
+    bool negative = false;
     size_t current_pos = 0;
 
     if (s[current_pos] == '+' || s[current_pos] == '-') {
-        if (s[current_pos] == '-') sign_multiplier = -1.0;
+        if (s[current_pos] == '-') negative = true;
         current_pos++;
     }
     s = s.substr(current_pos);
@@ -46,15 +59,15 @@ Monomial parseTerm(const std::string& term_str) {
         throw std::runtime_error("Ошибка парсинга члена: Неполный моном после знака в '" + term_str + "'.");
     }
 
-    double coeff_val = 1.0;
-    int px = 0, py = 0, pz = 0;
-    bool x_seen = false, y_seen = false, z_seen = false;
+    TCoeff coeff_val = TCoeff(1);
+    int powers[MAX_VARIABLES] = {};
+    bool seen[MAX_VARIABLES] = {};
 
     current_pos = 0;
     const char* start_ptr = s.c_str();
     char* end_ptr;
 
-    double parsed_coeff = std::strtod(start_ptr, &end_ptr);
+    TCoeff parsed_coeff = CoeffTraits<TCoeff>::parse(start_ptr, &end_ptr);
     size_t processed_len = end_ptr - start_ptr;
 
     bool number_was_parsed = false;
@@ -71,7 +84,7 @@ Monomial parseTerm(const std::string& term_str) {
             }
             if (pos_after_number < s.length()) {
                 char next_char = s[pos_after_number];
-                if (next_char == '*' || next_char == 'x' || next_char == 'y' || next_char == 'z') {
+                if (next_char == '*' || variableIndex<TLayout>(next_char) >= 0) {
                     coeff_val = parsed_coeff;
                     number_was_parsed = true;
                     s = s.substr(pos_after_number);
@@ -82,7 +95,7 @@ Monomial parseTerm(const std::string& term_str) {
                         throw std::runtime_error("Ошибка парсинга члена: Неожиданные символы '" + s.substr(pos_after_number) + "' после коэффициента в '" + term_str + "'.");
                     }
                     processed_len = 0;
-                    coeff_val = 1.0;
+                    coeff_val = TCoeff(1);
                 }
             }
             else {
@@ -93,7 +106,7 @@ Monomial parseTerm(const std::string& term_str) {
         }
     }
     else {
-        coeff_val = 1.0;
+        coeff_val = TCoeff(1);
     }
 
     if (!s.empty() && s[0] == '*') {
@@ -102,19 +115,7 @@ Monomial parseTerm(const std::string& term_str) {
     }
 
     while (!s.empty()) {
-        size_t var_pos_in_s = std::string::npos;
-        size_t pos_x = s.find('x');
-        size_t pos_y = s.find('y');
-        size_t pos_z = s.find('z');
-
-        if (pos_x != std::string::npos) var_pos_in_s = pos_x;
-        if (pos_y != std::string::npos) {
-            if (var_pos_in_s == std::string::npos || pos_y < var_pos_in_s) var_pos_in_s = pos_y;
-        }
-        if (pos_z != std::string::npos) {
-            if (var_pos_in_s == std::string::npos || pos_z < var_pos_in_s) var_pos_in_s = pos_z;
-        }
-
+        size_t var_pos_in_s = s.find_first_of(std::string(VARIABLE_NAMES, TLayout::VARIABLES));
 
         if (var_pos_in_s == std::string::npos) {
             bool only_asterisks_or_spaces = true;
@@ -135,9 +136,10 @@ Monomial parseTerm(const std::string& term_str) {
         }
 
         char var_char = s[var_pos_in_s];
+        int var = variableIndex<TLayout>(var_char);
         s = s.substr(var_pos_in_s + 1);
 
-        if ((var_char == 'x' && x_seen) || (var_char == 'y' && y_seen) || (var_char == 'z' && z_seen)) {
+        if (seen[var]) {
             throw std::runtime_error("Ошибка парсинга члена: Дублирование переменной '" + std::string(1, var_char) + "' в мономе '" + term_str + "'.");
         }
 
@@ -150,36 +152,49 @@ Monomial parseTerm(const std::string& term_str) {
             if (s.empty() || !std::isdigit(s[0])) {
                 throw std::runtime_error("Ошибка парсинга члена: Отсутствует или неверная степень после '^' для '" + std::string(1, var_char) + "' в '" + term_str + "'.");
             }
-            power = s[0] - '0';
-            if (power < MIN_DEGREE || power > MAX_DEGREE) {
-                throw std::out_of_range("Ошибка парсинга члена: Степень '" + std::string(1, s[0]) + "' вне допустимого диапазона (" + std::to_string(MIN_DEGREE) + "-" + std::to_string(MAX_DEGREE) + ") для '" + std::string(1, var_char) + "' в '" + term_str + "'.");
+            // Степень может быть многозначной, если раскладка допускает MaxDeg > 9
+            size_t digits = 0;
+            while (digits < s.length() && std::isdigit(s[digits])) {
+                digits++;
             }
-            s = s.substr(1);
+            std::string power_str = s.substr(0, digits);
+            if (digits > 9 || std::stoi(power_str) < MIN_DEGREE || std::stoi(power_str) > TLayout::MAX_DEGREE) {
+                throw std::out_of_range("Ошибка парсинга члена: Степень '" + power_str + "' вне допустимого диапазона (" + std::to_string(MIN_DEGREE) + "-" + std::to_string(TLayout::MAX_DEGREE) + ") для '" + std::string(1, var_char) + "' в '" + term_str + "'.");
+            }
+            power = std::stoi(power_str);
+            s = s.substr(digits);
             s = trim(s);
         }
 
-        if (var_char == 'x') { px = power; x_seen = true; }
-        else if (var_char == 'y') { py = power; y_seen = true; }
-        else if (var_char == 'z') { pz = power; z_seen = true; }
+        powers[var] = power;
+        seen[var] = true;
 
         if (!s.empty() && s[0] == '*') {
             s = s.substr(1);
             s = trim(s);
         }
     }
-    return { sign_multiplier * coeff_val, px, py, pz };
+    uint64_t key = 0;
+    for (int var = 0; var < TLayout::VARIABLES; ++var) {
+        key += powers[var] * TLayout::place(var);
+    }
+    return TMonomial<TCoeff, TLayout>::fromKey(negative ? -coeff_val : coeff_val, key);
 }
 
 // Функция для парсинга строки, содержащей представление полинома.
-// Возвращает объект Polynomial. Может выбрасывать исключения.
-Polynomial parsePolynomial(const std::string& input_string) {
+// Возвращает полином с коэффициентами типа TCoeff (по умолчанию double - Polynomial)
+// над мономами раскладки TLayout. Может выбрасывать исключения.
+template<class TCoeff = double, class TLayout = DefaultLayout>
+TPolynomial<TCoeff, TLayout> parsePolynomial(const std::string& input_string) {
+    using Polynomial = TPolynomial<TCoeff, TLayout>;
+
     std::string line = trim(input_string);
 
     if (line.empty()) {
         return Polynomial(); // Пустая строка соответствует нулевому полиному
     }
 
-    std::vector<Monomial> parsed_monomials;
+    TTermList<TCoeff, TLayout> parsed_monomials;
     size_t current_pos = 0;
 
     size_t first_term_start = line.find_first_not_of(" \t");
@@ -229,8 +244,8 @@ Polynomial parsePolynomial(const std::string& input_string) {
         std::string term_str = line.substr(current_pos, term_end_pos - current_pos);
 
         try {
-            Monomial m = parseTerm(term_str);
-            if (std::fabs(m.coeff) > EPSILON) {
+            TMonomial<TCoeff, TLayout> m = parseTerm<TCoeff, TLayout>(term_str);
+            if (!CoeffTraits<TCoeff>::isZero(m.coeff)) {
                 parsed_monomials.push_back(m);
             }
         }
@@ -252,15 +267,16 @@ Polynomial parsePolynomial(const std::string& input_string) {
     }
 
     // Создаем полином из разобранных мономов.
-    // Конструктор Polynomial(vector<Monomial>) автоматически вызывает canonicalize.
-    return Polynomial(parsed_monomials);
+    // Конструктор Polynomial(TermList) автоматически вызывает canonicalize.
+    return Polynomial(std::move(parsed_monomials));
 }
 
 
 // Оператор ввода для полинома.
 // Остается здесь, т.к. это стандартный способ парсинга из потоков.
 // Он вызывает parsePolynomial и обрабатывает ошибки потока.
-std::istream& operator>>(std::istream& istr, Polynomial& poly) {
+template<class TCoeff, class TLayout>
+std::istream& operator>>(std::istream& istr, TPolynomial<TCoeff, TLayout>& poly) {
     std::string line;
     // Читаем всю строку до символа новой строки
     if (!std::getline(istr, line)) {
@@ -271,7 +287,7 @@ std::istream& operator>>(std::istream& istr, Polynomial& poly) {
 
     try {
         // Используем новую функцию parsePolynomial для парсинга строки
-        poly = parsePolynomial(line);
+        poly = parsePolynomial<TCoeff, TLayout>(line);
         // Если парсинг успешен, полином poly обновлен, поток в goodbit состоянии (если был до getline).
     }
     catch (const std::runtime_error& e) {
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "polynomial.h"
+
+// Значения полинома на регулярной трехмерной сетке. Узел (ix, iy, iz) имеет
+// координаты узлов осей x, y, z; значения упорядочены по x, затем по y, затем
+// по z: индекс узла - (ix * ny + iy) * nz + iz. Срез - все узлы с одним ix.
+//
+// Сетка разделима, поэтому вычисление идет по уровням:
+//   Q(px, py)[iz]  = sum coeff * z^pz        - один раз на всю сетку,
+//   R(py)[iz]      = sum x^px * Q(px, py)[iz] - один раз на срез,
+//   value[iy][iz]  = sum y^py * R(py)[iz],
+// а степени координат каждой оси считаются один раз. Для плотного полинома
+// степени 9 это в десятки раз меньше операций, чем вычисление по точкам.
+
+// Прямоугольная область сетки: узлы оси var равномерно расположены от
+// low[var] до high[var] включительно (при одном узле - в low[var])
+struct GridBounds {
+    double low[3];
+    double high[3];
+};
+
+// Координаты n узлов оси var
+template<class TCoeff>
+std::vector<TCoeff> gridAxis(const GridBounds& bounds, int var, size_t n) {
+    std::vector<TCoeff> axis(n);
+    double step = n > 1 ? (bounds.high[var] - bounds.low[var]) / (n - 1) : 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        axis[i] = static_cast<TCoeff>(bounds.low[var] + step * i);
+    }
+    return axis;
+}
+
+// Степени координат оси: powers[e * n + i] = axis[i]^e для e <= max_degree
+template<class TCoeff>
+std::vector<TCoeff> gridPowers(const std::vector<TCoeff>& axis, int max_degree) {
+    const size_t n = axis.size();
+    std::vector<TCoeff> powers((max_degree + 1) * n, TCoeff(1));
+    for (int e = 1; e <= max_degree; ++e) {
+        for (size_t i = 0; i < n; ++i) {
+            powers[e * n + i] = powers[(e - 1) * n + i] * axis[i];
+        }
+    }
+    return powers;
+}
+
+// Вычисляет сетку по срезам: handler(ix, slice) вызывается для каждого ix по
+// порядку, slice - ny * nz значений среза (действителен только во время вызова)
+template<class TCoeff, class TLayout, class THandler>
+void evaluateGridSlices(const TPolynomial<TCoeff, TLayout>& poly, size_t nx, size_t ny, size_t nz,
+    const GridBounds& bounds, THandler handler) {
+    static_assert(TLayout::VARIABLES <= 3, "Сетка трехмерная: полином должен зависеть не более чем от x, y, z");
+    static_assert(!CoeffTraits<TCoeff>::exact, "Координаты узлов сетки вещественные");
+    if (nx == 0 || ny == 0 || nz == 0) return;
+
+    const auto& terms = poly.getTerms();
+    const int degree_x = poly.degree(0);
+    const int degree_y = TLayout::VARIABLES > 1 ? poly.degree(1) : 0;
+    const int degree_z = TLayout::VARIABLES > 2 ? poly.degree(2) : 0;
+    const std::vector<TCoeff> xs = gridAxis<TCoeff>(bounds, 0, nx);
+    const std::vector<TCoeff> y_powers = gridPowers(gridAxis<TCoeff>(bounds, 1, ny), degree_y);
+    const std::vector<TCoeff> z_powers = gridPowers(gridAxis<TCoeff>(bounds, 2, nz), degree_z);
+
+    // Мономы с общими (px, py) в каноническом порядке идут подряд; для каждой
+    // такой группы - сумма по z во всех узлах оси z
+    struct Group {
+        int px;
+        int py;
+    };
+    std::vector<Group> groups;
+    std::vector<TCoeff> q;
+    int e[3] = { 0, 0, 0 };
+    for (const auto& term : terms) {
+        TLayout::exponents(term.key, e);
+        if (groups.empty() || groups.back().px != e[0] || groups.back().py != e[1]) {
+            groups.push_back({ e[0], e[1] });
+            q.resize(q.size() + nz, TCoeff());
+        }
+        TCoeff* row = q.data() + (groups.size() - 1) * nz;
+        const TCoeff* z_row = z_powers.data() + e[2] * nz;
+        for (size_t iz = 0; iz < nz; ++iz) {
+            row[iz] += term.coeff * z_row[iz];
+        }
+    }
+
+    // Номер строки R для каждой встречающейся степени y
+    std::vector<int> py_row(degree_y + 1, -1);
+    std::vector<int> py_values;
+    for (const Group& g : groups) {
+        if (py_row[g.py] < 0) {
+            py_row[g.py] = static_cast<int>(py_values.size());
+            py_values.push_back(g.py);
+        }
+    }
+
+    std::vector<TCoeff> x_powers(degree_x + 1);
+    std::vector<TCoeff> r(py_values.size() * nz);
+    std::vector<TCoeff> slice(ny * nz);
+    for (size_t ix = 0; ix < nx; ++ix) {
+        x_powers[0] = TCoeff(1);
+        for (int p = 1; p <= degree_x; ++p) {
+            x_powers[p] = x_powers[p - 1] * xs[ix];
+        }
+
+        std::fill(r.begin(), r.end(), TCoeff());
+        for (size_t g = 0; g < groups.size(); ++g) {
+            const TCoeff weight = x_powers[groups[g].px];
+            TCoeff* r_row = r.data() + py_row[groups[g].py] * nz;
+            const TCoeff* q_row = q.data() + g * nz;
+            for (size_t iz = 0; iz < nz; ++iz) {
+                r_row[iz] += weight * q_row[iz];
+            }
+        }
+
+        std::fill(slice.begin(), slice.end(), TCoeff());
+        for (size_t iy = 0; iy < ny; ++iy) {
+            TCoeff* out = slice.data() + iy * nz;
+            for (size_t t = 0; t < py_values.size(); ++t) {
+                const TCoeff weight = y_powers[py_values[t] * ny + iy];
+                const TCoeff* r_row = r.data() + t * nz;
+                for (size_t iz = 0; iz < nz; ++iz) {
+                    out[iz] += weight * r_row[iz];
+                }
+            }
+        }
+        handler(ix, static_cast<const TCoeff*>(slice.data()));
+    }
+}
+
+// Значения во всех nx * ny * nz узлах сетки
+template<class TCoeff, class TLayout>
+std::vector<TCoeff> evaluateGrid(const TPolynomial<TCoeff, TLayout>& poly, size_t nx, size_t ny, size_t nz,
+    const GridBounds& bounds) {
+    std::vector<TCoeff> values(nx * ny * nz);
+    const size_t slice_size = ny * nz;
+    evaluateGridSlices(poly, nx, ny, nz, bounds, [&values, slice_size](size_t ix, const TCoeff* slice) {
+        std::copy(slice, slice + slice_size, values.begin() + ix * slice_size);
+    });
+    return values;
+}
+
+// Потоковая запись сетки: значения TCoeff в двоичном виде (в порядке байтов
+// машины) записываются срез за срезом, поэтому в памяти находится только один
+// срез и сетка 1024^3 не требует 8 ГБ
+template<class TCoeff, class TLayout>
+void writeGrid(const TPolynomial<TCoeff, TLayout>& poly, size_t nx, size_t ny, size_t nz,
+    const GridBounds& bounds, std::ostream& ostr) {
+    const std::streamsize slice_bytes = static_cast<std::streamsize>(ny * nz * sizeof(TCoeff));
+    evaluateGridSlices(poly, nx, ny, nz, bounds, [&ostr, slice_bytes](size_t, const TCoeff* slice) {
+        ostr.write(reinterpret_cast<const char*>(slice), slice_bytes);
+        if (!ostr) {
+            throw std::runtime_error("Ошибка записи сетки значений полинома в поток.");
+        }
+    });
+}
+
+template<class TCoeff, class TLayout>
+void saveGrid(const TPolynomial<TCoeff, TLayout>& poly, size_t nx, size_t ny, size_t nz,
+    const GridBounds& bounds, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Не удалось открыть файл '" + path + "' для записи сетки.");
+    }
+    writeGrid(poly, nx, ny, nz, bounds, file);
+}
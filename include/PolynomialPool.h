@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+#include "polynomial.h"
+
+// Неизменяемый разделяемый полином, выданный пулом
+template<class TCoeff, class TLayout = DefaultLayout>
+using TPolynomialHandle = std::shared_ptr<const TPolynomial<TCoeff, TLayout>>;
+
+using PolynomialHandle = TPolynomialHandle<double>;
+
+// Пул интернирования: для равных полиномов возвращает один и тот же дескриптор.
+// Хранилища, в которых много одинаковых результатов, держат по одному экземпляру
+// каждого значения, а равенство интернированных полиномов проверяется
+// сравнением указателей. Пул не потокобезопасен.
+//
+// Вещественные коэффициенты сравниваются точно, а не с допуском EPSILON, как в
+// operator==: равенство с допуском нетранзитивно, и согласованного с ним хеша не
+// существует (std::hash<Polynomial> квантует коэффициенты, поэтому равные с
+// допуском полиномы по разные стороны границы шага получили бы разные хеши и
+// были бы интернированы дважды). Полиномы, отличающиеся в пределах EPSILON,
+// получают разные дескрипторы.
+template<class TCoeff, class TLayout = DefaultLayout>
+class TPolynomialPool {
+public:
+    using Polynomial = TPolynomial<TCoeff, TLayout>;
+    using PolynomialHandle = TPolynomialHandle<TCoeff, TLayout>;
+
+private:
+    using Traits = CoeffTraits<TCoeff>;
+
+    static size_t coeffHash(const TCoeff& c, std::true_type /*exact*/) {
+        return Traits::hash(c);
+    }
+
+    static size_t coeffHash(const TCoeff& c, std::false_type /*exact*/) {
+        return std::hash<TCoeff>()(c);
+    }
+
+    struct HandleHash {
+        size_t operator()(const PolynomialHandle& handle) const {
+            size_t result = 0;
+            for (const auto& term : handle->getTerms()) {
+                size_t value = static_cast<size_t>(term.key) * 0x9e3779b97f4a7c15ULL
+                    ^ coeffHash(term.coeff, std::integral_constant<bool, Traits::exact>());
+                result ^= value + 0x9e3779b97f4a7c15ULL + (result << 6) + (result >> 2);
+            }
+            return result;
+        }
+    };
+
+    struct HandleEqual {
+        bool operator()(const PolynomialHandle& a, const PolynomialHandle& b) const {
+            const auto& a_terms = a->getTerms();
+            const auto& b_terms = b->getTerms();
+            if (a_terms.size() != b_terms.size()) return false;
+            for (size_t i = 0; i < a_terms.size(); ++i) {
+                if (a_terms[i].key != b_terms[i].key || !(a_terms[i].coeff == b_terms[i].coeff)) return false;
+            }
+            return true;
+        }
+    };
+
+    std::unordered_set<PolynomialHandle, HandleHash, HandleEqual> handles;
+
+    // Поиск без выделения памяти: временный дескриптор не владеет полиномом
+    PolynomialHandle find(const Polynomial& poly) const {
+        auto it = handles.find(PolynomialHandle(PolynomialHandle(), &poly));
+        return it == handles.end() ? PolynomialHandle() : *it;
+    }
+
+public:
+    // Возвращает дескриптор полинома, совпадающего с poly; новый полином копируется
+    // (или перемещается) в пул, только если равного в пуле еще нет
+    PolynomialHandle intern(const Polynomial& poly) {
+        PolynomialHandle found = find(poly);
+        if (found) return found;
+        PolynomialHandle handle = std::make_shared<const Polynomial>(poly);
+        handles.insert(handle);
+        return handle;
+    }
+
+    PolynomialHandle intern(Polynomial&& poly) {
+        PolynomialHandle found = find(poly);
+        if (found) return found;
+        PolynomialHandle handle = std::make_shared<const Polynomial>(std::move(poly));
+        handles.insert(handle);
+        return handle;
+    }
+
+    // Удаляет из пула полиномы, на которые больше никто не ссылается
+    size_t collect() {
+        size_t removed = 0;
+        for (auto it = handles.begin(); it != handles.end();) {
+            if (it->use_count() == 1) {
+                it = handles.erase(it);
+                ++removed;
+            }
+            else {
+                ++it;
+            }
+        }
+        return removed;
+    }
+
+    size_t size() const {
+        return handles.size();
+    }
+
+    bool empty() const {
+        return handles.empty();
+    }
+
+    void clear() {
+        handles.clear();
+    }
+};
+
+using PolynomialPool = TPolynomialPool<double>;
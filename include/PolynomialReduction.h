@@ -0,0 +1,321 @@
+﻿#pragma once
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "polynomial.h"
+#include "ThreadPool.h"
+
+// Свертки над наборами полиномов (сумма и произведение). Принимают любой
+// диапазон итераторов, у которого разыменование дает Polynomial или пару
+// (ключ, Polynomial), то есть итераторы всех шести хранилищ из include/ и
+// обычные контейнеры полиномов.
+
+// Суммарное число мономов, начиная с которого сумма считается в плотном массиве
+const size_t DENSE_SUM_THRESHOLD = static_cast<size_t>(DENSE_FILL_RATIO * MONOMIAL_KEY_COUNT);
+
+// Минимальное число полиномов на поток при параллельной свертке
+const size_t PARALLEL_MIN_OPERANDS = 16;
+
+template<class TCoeff, class TLayout>
+const TPolynomial<TCoeff, TLayout>& polynomialOf(const TPolynomial<TCoeff, TLayout>& p) {
+    return p;
+}
+
+template<class TCoeff, class TLayout>
+TPolynomial<TCoeff, TLayout>&& polynomialOf(TPolynomial<TCoeff, TLayout>&& p) {
+    return std::move(p);
+}
+
+template<class TKey, class TCoeff, class TLayout>
+const TPolynomial<TCoeff, TLayout>& polynomialOf(const std::pair<TKey, TPolynomial<TCoeff, TLayout>>& item) {
+    return item.second;
+}
+
+template<class TKey, class TCoeff, class TLayout>
+TPolynomial<TCoeff, TLayout>&& polynomialOf(std::pair<TKey, TPolynomial<TCoeff, TLayout>>&& item) {
+    return std::move(item.second);
+}
+
+// Тип полинома, на который указывает итератор TIter
+template<class TIter>
+using PolynomialOf = typename std::decay<decltype(polynomialOf(*std::declval<TIter>()))>::type;
+
+// Собирает указатели на полиномы диапазона. Если итератор возвращает значение,
+// а не ссылку (как TAVLTree), полином перемещается в owned.
+template<class TItem, class Polynomial>
+void collectPolynomial(TItem&& item, std::vector<const Polynomial*>& polys, std::deque<Polynomial>& owned) {
+    if (std::is_lvalue_reference<TItem>::value) {
+        polys.push_back(&polynomialOf(item));
+    }
+    else {
+        owned.push_back(polynomialOf(std::forward<TItem>(item)));
+        polys.push_back(&owned.back());
+    }
+}
+
+template<class TIter, class Polynomial = PolynomialOf<TIter>>
+std::vector<const Polynomial*> collectPolynomials(TIter first, TIter last, std::deque<Polynomial>& owned) {
+    std::vector<const Polynomial*> polys;
+    for (; first != last; ++first) {
+        collectPolynomial(*first, polys, owned);
+    }
+    return polys;
+}
+
+// Сумма k канонических полиномов слиянием через кучу: O(N log k) для N мономов
+template<class Polynomial>
+Polynomial sumMerge(const std::vector<const Polynomial*>& polys) {
+    using TermList = typename Polynomial::TermList;
+    using Monomial = typename Polynomial::Monomial;
+    using Traits = CoeffTraits<typename Polynomial::coeff_type>;
+
+    struct HeapEntry {
+        uint64_t key;
+        size_t poly;
+        size_t pos;
+    };
+    auto less_key = [](const HeapEntry& l, const HeapEntry& r) { return l.key < r.key; };
+
+    std::vector<HeapEntry> heap;
+    size_t total = 0;
+    for (size_t i = 0; i < polys.size(); ++i) {
+        const TermList& terms = polys[i]->getTerms();
+        total += terms.size();
+        if (!terms.empty()) {
+            heap.push_back({ terms[0].key, i, 0 });
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), less_key);
+
+    TermList result;
+    result.reserve(total);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), less_key);
+        HeapEntry& top = heap.back();
+        const TermList& terms = polys[top.poly]->getTerms();
+        auto coeff = terms[top.pos].coeff;
+
+        if (!result.empty() && result.back().key == top.key) {
+            result.back().coeff += coeff;
+        }
+        else {
+            if (!result.empty() && Traits::isZero(result.back().coeff)) {
+                result.pop_back();
+            }
+            result.push_back(Monomial::fromKey(coeff, top.key));
+        }
+
+        if (++top.pos < terms.size()) {
+            top.key = terms[top.pos].key;
+            std::push_heap(heap.begin(), heap.end(), less_key);
+        }
+        else {
+            heap.pop_back();
+        }
+    }
+    if (!result.empty() && Traits::isZero(result.back().coeff)) {
+        result.pop_back();
+    }
+    return Polynomial::fromCanonical(std::move(result));
+}
+
+// Сумма накоплением в плотном массиве потока: O(N + KEY_COUNT)
+template<class Polynomial>
+Polynomial sumDense(const std::vector<const Polynomial*>& polys) {
+    typename Polynomial::DenseScratch lease;
+    typename Polynomial::DensePolynomial& acc = *lease;
+    KeyRange range;
+    for (const Polynomial* p : polys) {
+        const auto& terms = p->getTerms();
+        if (terms.empty()) continue;
+        acc.add(terms);
+        range.include(terms.back().key, terms.front().key);
+    }
+    if (range.high < range.low) {
+        return Polynomial();
+    }
+    return Polynomial::fromCanonical(acc.extractTerms(range.low, range.high));
+}
+
+template<class Polynomial>
+Polynomial sumPolynomials(const std::vector<const Polynomial*>& polys) {
+    size_t total = 0;
+    for (const Polynomial* p : polys) {
+        total += p->getTerms().size();
+    }
+    // Порог пропорционален пространству ключей; без плотного массива - только слияние
+    using Layout = typename Polynomial::Layout;
+    if (Layout::DENSE && total >= DENSE_SUM_THRESHOLD * Layout::DENSE_SIZE / MONOMIAL_KEY_COUNT) {
+        return sumDense(polys);
+    }
+    return sumMerge(polys);
+}
+
+// Сумма polys по частям на потоках пула: каждая задача суммирует свою часть,
+// затем частичные суммы складываются
+template<class Polynomial>
+Polynomial sumParallel(const std::vector<const Polynomial*>& polys, size_t chunks, ThreadPool& pool) {
+    // Нормализуем заранее, чтобы потоки только читали полиномы
+    for (const Polynomial* p : polys) {
+        p->getTerms();
+    }
+
+    size_t chunk_size = (polys.size() + chunks - 1) / chunks;
+    std::vector<Polynomial> partial_sums((polys.size() + chunk_size - 1) / chunk_size);
+    pool.parallelFor(partial_sums.size(), [&](size_t part) {
+        size_t begin = part * chunk_size;
+        size_t end = std::min(polys.size(), begin + chunk_size);
+        std::vector<const Polynomial*> chunk(polys.begin() + begin, polys.begin() + end);
+        partial_sums[part] = sumPolynomials(chunk);
+    });
+
+    std::vector<const Polynomial*> partial_ptrs;
+    for (const auto& p : partial_sums) {
+        partial_ptrs.push_back(&p);
+    }
+    return sumPolynomials(partial_ptrs);
+}
+
+// Сумма всех полиномов диапазона на потоках пула pool (вызывающий поток тоже
+// участвует). Диапазон делится не больше чем на pool.size() + 1 частей.
+template<class TIter, class Polynomial = PolynomialOf<TIter>>
+Polynomial sum(TIter first, TIter last, ThreadPool& pool) {
+    std::deque<Polynomial> owned;
+    std::vector<const Polynomial*> polys = collectPolynomials(first, last, owned);
+    size_t chunks = std::min<size_t>(pool.size() + 1, polys.size() / PARALLEL_MIN_OPERANDS);
+    if (chunks <= 1) {
+        return sumPolynomials(polys);
+    }
+    return sumParallel(polys, chunks, pool);
+}
+
+// То же с threads потоками: при threads > 1 создается пул на время вычисления
+template<class TIter, class Polynomial = PolynomialOf<TIter>>
+Polynomial sum(TIter first, TIter last, unsigned threads = 1) {
+    std::deque<Polynomial> owned;
+    std::vector<const Polynomial*> polys = collectPolynomials(first, last, owned);
+    size_t chunks = std::min<size_t>(threads, polys.size() / PARALLEL_MIN_OPERANDS);
+    if (chunks <= 1) {
+        return sumPolynomials(polys);
+    }
+    ThreadPool pool(threads - 1); // вызывающий поток тоже выполняет задачи
+    return sumParallel(polys, chunks, pool);
+}
+
+template<class TRange>
+auto sum(TRange& range, unsigned threads = 1) -> decltype(sum(range.begin(), range.end(), threads)) {
+    return sum(range.begin(), range.end(), threads);
+}
+
+template<class TRange>
+auto sum(TRange& range, ThreadPool& pool) -> decltype(sum(range.begin(), range.end(), pool)) {
+    return sum(range.begin(), range.end(), pool);
+}
+
+// Произведение полиномов polys[low, high) сбалансированным деревом: соседние
+// сомножители перемножаются попарно, поэтому промежуточные полиномы растут
+// равномерно. Пока depth > 0, поддеревья считаются задачами пула.
+template<class Polynomial>
+Polynomial productTree(const std::vector<const Polynomial*>& polys, size_t low, size_t high, unsigned depth, ThreadPool* pool) {
+    if (high - low == 1) {
+        return *polys[low];
+    }
+    if (high - low == 2) {
+        return *polys[low] * *polys[low + 1];
+    }
+    size_t mid = low + (high - low) / 2;
+    if (depth == 0 || pool == nullptr) {
+        return productTree(polys, low, mid, 0, pool) * productTree(polys, mid, high, 0, pool);
+    }
+    Polynomial halves[2];
+    pool->parallelFor(2, [&](size_t half) {
+        halves[half] = half == 0 ? productTree(polys, low, mid, depth - 1, pool)
+                                 : productTree(polys, mid, high, depth - 1, pool);
+    });
+    return halves[0] * halves[1];
+}
+
+// Глубина дерева, до которой поддеревья считаются параллельно: не больше
+// потоков, чем threads, и не меньше двух сомножителей на поддерево
+inline unsigned productTreeDepth(size_t operands, unsigned threads) {
+    unsigned depth = 0;
+    while ((2u << depth) <= threads && (2u << depth) <= operands / 2) {
+        ++depth;
+    }
+    return depth;
+}
+
+// Проверка степеней и вырожденные случаи произведения. Возвращает false,
+// если результат уже записан в result.
+template<class Polynomial>
+bool prepareProduct(const std::vector<const Polynomial*>& polys, Polynomial& result) {
+    using TCoeff = typename Polynomial::coeff_type;
+    using Layout = typename Polynomial::Layout;
+    if (polys.empty()) {
+        result = Polynomial({ typename Polynomial::Monomial(TCoeff(1)) });
+        return false;
+    }
+    for (const Polynomial* p : polys) {
+        if (p->getTerms().empty()) {
+            result = Polynomial();
+            return false;
+        }
+    }
+
+    for (int var = 0; var < Layout::VARIABLES; ++var) {
+        int total_degree = 0;
+        for (const Polynomial* p : polys) {
+            total_degree += p->degree(var);
+        }
+        if (total_degree > Layout::MAX_DEGREE) {
+            throw std::out_of_range("Ошибка умножения полиномов: Умножение мономов приводит к степеням вне допустимого диапазона (0-" + std::to_string(Layout::MAX_DEGREE) + ").");
+        }
+    }
+    return true;
+}
+
+// Произведение всех полиномов диапазона на потоках пула pool и вызывающем
+// потоке (всего pool.size() + 1 исполнителей). Степени проверяются до начала
+// умножений: если сумма степеней по какой-либо переменной больше MAX_DEGREE,
+// сразу бросается то же исключение, что и у operator*. Пустой диапазон дает 1.
+template<class TIter, class Polynomial = PolynomialOf<TIter>>
+Polynomial product(TIter first, TIter last, ThreadPool& pool) {
+    std::deque<Polynomial> owned;
+    std::vector<const Polynomial*> polys = collectPolynomials(first, last, owned);
+    Polynomial result;
+    if (!prepareProduct(polys, result)) {
+        return result;
+    }
+    return productTree(polys, 0, polys.size(), productTreeDepth(polys.size(), pool.size() + 1), &pool);
+}
+
+// То же с threads потоками: при threads > 1 создается пул на время вычисления
+template<class TIter, class Polynomial = PolynomialOf<TIter>>
+Polynomial product(TIter first, TIter last, unsigned threads = 1) {
+    std::deque<Polynomial> owned;
+    std::vector<const Polynomial*> polys = collectPolynomials(first, last, owned);
+    Polynomial result;
+    if (!prepareProduct(polys, result)) {
+        return result;
+    }
+    unsigned depth = productTreeDepth(polys.size(), threads);
+    if (depth == 0) {
+        return productTree<Polynomial>(polys, 0, polys.size(), 0, nullptr);
+    }
+    ThreadPool pool(threads - 1); // вызывающий поток тоже выполняет задачи
+    return productTree(polys, 0, polys.size(), depth, &pool);
+}
+
+template<class TRange>
+auto product(TRange& range, unsigned threads = 1) -> decltype(product(range.begin(), range.end(), threads)) {
+    return product(range.begin(), range.end(), threads);
+}
+
+template<class TRange>
+auto product(TRange& range, ThreadPool& pool) -> decltype(product(range.begin(), range.end(), pool)) {
+    return product(range.begin(), range.end(), pool);
+}
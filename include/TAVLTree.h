@@ -111,20 +111,23 @@ private:
         return node;
     }
 
-    Node* insert(Node* node, Node* parent, const TKey& key, const TValue& value) {
+    // Значение передается по цепочке рекурсии без копирования и копируется
+    // или перемещается только в узел
+    template<class V>
+    Node* insert(Node* node, Node* parent, const TKey& key, V&& value) {
         if (!node) {
             tree_size++;
-            return new Node(key, value, parent);
+            return new Node(key, std::forward<V>(value), parent);
         }
 
         if (key < node->key) {
-            node->left = insert(node->left, node, key, value);
+            node->left = insert(node->left, node, key, std::forward<V>(value));
         }
         else if (key > node->key) {
-            node->right = insert(node->right, node, key, value);
+            node->right = insert(node->right, node, key, std::forward<V>(value));
         }
         else {
-            node->value = value;
+            node->value = std::forward<V>(value);
             return node;
         }
 
@@ -227,13 +230,35 @@ public:
     TAVLTree(const TAVLTree& other) = delete;
     TAVLTree& operator=(const TAVLTree& other) = delete;
 
-    TAVLTree(TAVLTree&& other) noexcept = default;
-    TAVLTree& operator=(TAVLTree&& other) noexcept = default;
+    TAVLTree(TAVLTree&& other) noexcept : root(other.root), tree_size(other.tree_size) {
+        other.root = nullptr;
+        other.tree_size = 0;
+    }
+
+    TAVLTree& operator=(TAVLTree&& other) noexcept {
+        if (this != &other) {
+            destroy(root);
+            root = other.root;
+            tree_size = other.tree_size;
+            other.root = nullptr;
+            other.tree_size = 0;
+        }
+        return *this;
+    }
 
     void insert(const TKey& key, const TValue& value) {
         root = insert(root, nullptr, key, value);
         if (root) root->parent = nullptr;
     }
+    void insert(const TKey& key, TValue&& value) {
+        root = insert(root, nullptr, key, std::move(value));
+        if (root) root->parent = nullptr;
+    }
+    // Значение строится из args и перемещается в узел без копирования
+    template<class... Args>
+    void emplace(const TKey& key, Args&&... args) {
+        insert(key, TValue(std::forward<Args>(args)...));
+    }
     void erase(const TKey& key) {
         root = erase(root, key);
         if (root) root->parent = nullptr;
@@ -76,18 +76,17 @@ public:
     };
 
     iterator insert(const TKey& key, const TValue& value) {
-        size_t i = 0;
-        while (i < table.size() && table[i].first < key) {
-            i++;
-        }
-        if (i < table.size() && table[i].first == key) {
-            table[i].second = value;
-            return iterator(&table[i]);
-        }
-        table.emplace_back(key, value);
-        std::move_backward(table.begin() + i, table.begin() + table.size() - 1, table.begin() + table.size());
-        table[i] = std::pair<TKey, TValue>(key, value);
-        return iterator(&table[i]);
+        return insertValue(key, value);
+    }
+
+    iterator insert(const TKey& key, TValue&& value) {
+        return insertValue(key, std::move(value));
+    }
+
+    // Значение строится из args и перемещается в таблицу без копирования
+    template<class... Args>
+    iterator emplace(const TKey& key, Args&&... args) {
+        return insertValue(key, TValue(std::forward<Args>(args)...));
     }
 
     iterator erase(const TKey& key) {
@@ -147,6 +146,22 @@ public:
         }
         std::cout << "-------------------------------------------\n";
     }
+
+private:
+    // Значение копируется или перемещается в таблицу в зависимости от категории аргумента
+    template<class V>
+    iterator insertValue(const TKey& key, V&& value) {
+        size_t i = 0;
+        while (i < table.size() && table[i].first < key) {
+            i++;
+        }
+        if (i < table.size() && table[i].first == key) {
+            table[i].second = std::forward<V>(value);
+            return iterator(&table[i]);
+        }
+        table.emplace(table.begin() + i, key, std::forward<V>(value));
+        return iterator(&table[i]);
+    }
 };
 
 
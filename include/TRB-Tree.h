@@ -25,6 +25,12 @@ public:
             Node* l = nullptr, Node* r = nullptr)
             : left(l), right(r), parent(p), data(std::make_pair(key, value)), color(c) {
         }
+
+        Node(const TKey& key, TValue&& value,
+            Color c = Color::RED, Node* p = nullptr,
+            Node* l = nullptr, Node* r = nullptr)
+            : left(l), right(r), parent(p), data(key, std::move(value)), color(c) {
+        }
     };
 
 private:
@@ -334,6 +340,19 @@ public:
         return *this;
     }
 
+    RBTree(RBTree&& other) : RBTree() {
+        std::swap(root, other.root);
+        std::swap(nil_node, other.nil_node);
+    }
+
+    RBTree& operator=(RBTree&& other) {
+        if (this != &other) {
+            std::swap(root, other.root);
+            std::swap(nil_node, other.nil_node);
+        }
+        return *this;
+    }
+
     ~RBTree() {
         clearRecursive(root);
         delete nil_node;
@@ -348,38 +367,17 @@ public:
     }
 
     std::pair<iterator, bool> insert(const TKey& key, const TValue& value) {
-        Node* z = new Node(key, value, Color::RED, nullptr, nil_node, nil_node);
-        Node* y = nullptr;
-        Node* x = this->root;
-        bool inserted_new = true;
+        return insertNode(new Node(key, value, Color::RED, nullptr, nil_node, nil_node));
+    }
 
-        while (x != nil_node) {
-            y = x;
-            if (z->data.first < x->data.first) {
-                x = x->left;
-            }
-            else if (z->data.first > x->data.first) {
-                x = x->right;
-            }
-            else {
-                x->data.second = value;
-                delete z;
-                inserted_new = false;
-                return { iterator(x, this), false };
-            }
-        }
-        z->parent = y;
-        if (y == nullptr) {
-            this->root = z;
-        }
-        else if (z->data.first < y->data.first) {
-            y->left = z;
-        }
-        else {
-            y->right = z;
-        }
-        insertFixup(z);
-        return { iterator(z, this), inserted_new };
+    std::pair<iterator, bool> insert(const TKey& key, TValue&& value) {
+        return insertNode(new Node(key, std::move(value), Color::RED, nullptr, nil_node, nil_node));
+    }
+
+    // Значение строится из args и перемещается в узел без копирования
+    template<class... Args>
+    std::pair<iterator, bool> emplace(const TKey& key, Args&&... args) {
+        return insertNode(new Node(key, TValue(std::forward<Args>(args)...), Color::RED, nullptr, nil_node, nil_node));
     }
 
     iterator find(const TKey& key) const {
@@ -447,6 +445,42 @@ public:
     }
 
 private:
+    // Вставка уже созданного узла; при совпадении ключа значение переносится
+    // в существующий узел, а новый узел удаляется
+    std::pair<iterator, bool> insertNode(Node* z) {
+        Node* y = nullptr;
+        Node* x = this->root;
+        bool inserted_new = true;
+
+        while (x != nil_node) {
+            y = x;
+            if (z->data.first < x->data.first) {
+                x = x->left;
+            }
+            else if (z->data.first > x->data.first) {
+                x = x->right;
+            }
+            else {
+                x->data.second = std::move(z->data.second);
+                delete z;
+                inserted_new = false;
+                return { iterator(x, this), false };
+            }
+        }
+        z->parent = y;
+        if (y == nullptr) {
+            this->root = z;
+        }
+        else if (z->data.first < y->data.first) {
+            y->left = z;
+        }
+        else {
+            y->right = z;
+        }
+        insertFixup(z);
+        return { iterator(z, this), inserted_new };
+    }
+
     void printBT(const std::string& prefix, const Node* node, bool isLeft) const {
         if (node != nil_node) {
             std::cout << prefix;
@@ -0,0 +1,272 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <atomic>
+
+// Вектор с встроенным буфером на N элементов: пока элементов не больше N,
+// они хранятся прямо в объекте и память в куче не выделяется. При переполнении
+// элементы переносятся в кучу. Предназначен для тривиально копируемых типов
+// (например, Monomial), поэтому перенос выполняется через memcpy.
+//
+// Буфер в куче разделяется между копиями (копирование на запись): копия лишь
+// увеличивает атомарный счетчик ссылок, а собственный экземпляр буфера
+// создается при первом изменении через неконстантный доступ (begin, [],
+// push_back, ...). Разделяемый буфер не изменяется, поэтому разные потоки могут
+// читать и копировать один объект одновременно - но только через константный
+// доступ, иначе чтение само отделяет буфер.
+template<class T, size_t N>
+class TSmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "TSmallVector хранит только тривиально копируемые типы");
+
+    // Заголовок блока в куче; элементы лежат сразу за ним
+    struct HeapHeader {
+        std::atomic<uint32_t> refs;
+    };
+
+    static constexpr size_t HEADER_SIZE = (sizeof(HeapHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    T* items;
+    uint32_t count;
+    uint32_t cap;
+    alignas(T) unsigned char local[N * sizeof(T)];
+
+    T* localData() {
+        return reinterpret_cast<T*>(local);
+    }
+
+    bool isLocal() const {
+        return items == reinterpret_cast<const T*>(local);
+    }
+
+    HeapHeader* header() const {
+        return reinterpret_cast<HeapHeader*>(reinterpret_cast<unsigned char*>(items) - HEADER_SIZE);
+    }
+
+    static T* allocate(size_t capacity) {
+        unsigned char* block = static_cast<unsigned char*>(::operator new(HEADER_SIZE + capacity * sizeof(T)));
+        new (block) HeapHeader{ {1} };
+        return reinterpret_cast<T*>(block + HEADER_SIZE);
+    }
+
+    void releaseHeap() {
+        if (!isLocal()) {
+            HeapHeader* h = header();
+            if (h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                h->~HeapHeader();
+                ::operator delete(static_cast<void*>(h));
+            }
+        }
+    }
+
+    void grow(size_t min_capacity) {
+        size_t new_capacity = std::max(min_capacity, static_cast<size_t>(cap) * 2);
+        T* new_items = allocate(new_capacity);
+        if (count > 0) {
+            std::memcpy(static_cast<void*>(new_items), items, count * sizeof(T));
+        }
+        releaseHeap();
+        items = new_items;
+        cap = static_cast<uint32_t>(new_capacity);
+    }
+
+    // Перед изменением: если буфер разделяется с другими копиями, создать свой
+    void detach() {
+        if (isShared()) {
+            T* new_items = allocate(cap);
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(new_items), items, count * sizeof(T));
+            }
+            releaseHeap();
+            items = new_items;
+        }
+    }
+
+    void shareFrom(const TSmallVector& other) {
+        if (other.isLocal()) {
+            items = localData();
+            cap = N;
+            count = 0;
+            assignFrom(other.items, other.count);
+        }
+        else {
+            other.header()->refs.fetch_add(1, std::memory_order_relaxed);
+            items = other.items;
+            cap = other.cap;
+            count = other.count;
+        }
+    }
+
+    void assignFrom(const T* first, size_t n) {
+        if (n > cap) {
+            grow(n);
+        }
+        detach();
+        if (n > 0) {
+            std::memcpy(static_cast<void*>(items), first, n * sizeof(T));
+        }
+        count = static_cast<uint32_t>(n);
+    }
+
+    // Забирает содержимое other; other остается пустым и использует свой встроенный буфер
+    void steal(TSmallVector& other) noexcept {
+        if (other.isLocal()) {
+            items = localData();
+            cap = N;
+            if (other.count > 0) {
+                std::memcpy(static_cast<void*>(items), other.items, other.count * sizeof(T));
+            }
+        }
+        else {
+            items = other.items;
+            cap = other.cap;
+            other.items = other.localData();
+            other.cap = N;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    TSmallVector() : items(localData()), count(0), cap(N) {}
+
+    template<class TIter, class = typename std::iterator_traits<TIter>::iterator_category>
+    TSmallVector(TIter first, TIter last) : TSmallVector() {
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    TSmallVector(const TSmallVector& other) {
+        shareFrom(other);
+    }
+
+    TSmallVector(TSmallVector&& other) noexcept {
+        steal(other);
+    }
+
+    TSmallVector& operator=(const TSmallVector& other) {
+        if (this != &other) {
+            releaseHeap();
+            shareFrom(other);
+        }
+        return *this;
+    }
+
+    TSmallVector& operator=(TSmallVector&& other) noexcept {
+        if (this != &other) {
+            releaseHeap();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~TSmallVector() {
+        releaseHeap();
+    }
+
+    // Неконстантный доступ отделяет разделяемый буфер
+    iterator begin() { detach(); return items; }
+    iterator end() { detach(); return items + count; }
+    const_iterator begin() const { return items; }
+    const_iterator end() const { return items + count; }
+
+    T* data() { detach(); return items; }
+    const T* data() const { return items; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return isLocal(); }
+
+    // Буфер в куче разделяется хотя бы с одной копией
+    bool isShared() const {
+        return !isLocal() && header()->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    T& operator[](size_t i) { detach(); return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+
+    T& front() { detach(); return items[0]; }
+    const T& front() const { return items[0]; }
+    T& back() { detach(); return items[count - 1]; }
+    const T& back() const { return items[count - 1]; }
+
+    void reserve(size_t n) {
+        if (n > cap) {
+            grow(n);
+        }
+    }
+
+    void push_back(const T& value) {
+        T copy = value; // value может лежать в самом буфере
+        if (count == cap) {
+            grow(count + 1);
+        }
+        else {
+            detach();
+        }
+        items[count++] = copy;
+    }
+
+    void pop_back() {
+        --count;
+    }
+
+    void resize(size_t n) {
+        reserve(n);
+        detach();
+        for (size_t i = count; i < n; ++i) {
+            new (items + i) T();
+        }
+        count = static_cast<uint32_t>(n);
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_t first_index = static_cast<size_t>(first - items);
+        size_t last_index = static_cast<size_t>(last - items);
+        detach();
+        T* dst = items + first_index;
+        size_t tail = count - last_index;
+        if (first_index != last_index && tail > 0) {
+            std::memmove(static_cast<void*>(dst), items + last_index, tail * sizeof(T));
+        }
+        count -= static_cast<uint32_t>(last_index - first_index);
+        return dst;
+    }
+
+    // Вставка диапазона в конец (единственный вид вставки, нужный полиномам)
+    template<class TIter>
+    void append(TIter first, TIter last) {
+        reserve(count + static_cast<size_t>(std::distance(first, last)));
+        detach();
+        for (; first != last; ++first) {
+            items[count++] = *first;
+        }
+    }
+
+    bool operator==(const TSmallVector& other) const {
+        if (count != other.count) return false;
+        return items == other.items || std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const TSmallVector& other) const {
+        return !(*this == other);
+    }
+};
@@ -107,14 +107,17 @@ public:
     }
 
     iterator insert(const TKey& key, const TValue& value) {
-        iterator existing_it = find(key); 
-        if (existing_it != end()) {     
-            existing_it.value() = value;
-            return existing_it;
-        }
+        return insertValue(key, value);
+    }
 
-        table.emplace_back(key, value);
-        return iterator(&table.back());
+    iterator insert(const TKey& key, TValue&& value) {
+        return insertValue(key, std::move(value));
+    }
+
+    // Значение строится из args и перемещается в таблицу без копирования
+    template<class... Args>
+    iterator emplace(const TKey& key, Args&&... args) {
+        return insertValue(key, TValue(std::forward<Args>(args)...));
     }
 
     iterator erase(const TKey& key) {
@@ -183,4 +186,18 @@ public:
         }
         std::cout << "-------------------------------------------\n";
     }
+
+private:
+    // Значение копируется или перемещается в таблицу в зависимости от категории аргумента
+    template<class V>
+    iterator insertValue(const TKey& key, V&& value) {
+        iterator existing_it = find(key); 
+        if (existing_it != end()) {     
+            existing_it.value() = std::forward<V>(value);
+            return existing_it;
+        }
+
+        table.emplace_back(key, std::forward<V>(value));
+        return iterator(&table.back());
+    }
 };
\ No newline at end of file
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+// Пул потоков с перехватом работы (work stealing). У каждого потока своя
+// очередь задач: владелец берет задачи с конца, а освободившийся поток
+// забирает их с начала чужой очереди. Поэтому неравномерные по времени задачи
+// сами распределяются между потоками, а задачи одного потока обычно идут
+// подряд по данным. Поток, ожидающий parallelFor, тоже выполняет задачи, так
+// что вложенный parallelFor изнутри задачи не приводит к взаимной блокировке.
+class ThreadPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{ 0 };
+    std::atomic<size_t> stolen{ 0 };
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Выполняет одну задачу: свою с конца очереди или чужую с начала
+    bool runOne(size_t self) {
+        std::function<void()> task;
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; !task && i < queues.size(); ++i) {
+            Queue& victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen.fetch_add(1);
+            }
+        }
+        if (!task) return false;
+        queued.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    void workerLoop(size_t self) {
+        while (true) {
+            if (runOne(self)) continue;
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+    void push(size_t queue, std::function<void()> task) {
+        Queue& target = *queues[queue];
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.tasks.push_back(std::move(task));
+        queued.fetch_add(1);
+    }
+
+    void notifyWorkers() {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake.notify_all();
+    }
+
+public:
+    // threads == 0 - по числу аппаратных потоков
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    // Сколько задач выполнено не владельцем очереди, а перехватом
+    size_t steals() const {
+        return stolen.load();
+    }
+
+    // Выполняет f(i) для всех i из [0, count) и ждет завершения. Индексы
+    // раздаются потокам непрерывными диапазонами, остальное - перехватом.
+    // Первое исключение из f перебрасывается вызывающему после завершения всех задач.
+    template<class F>
+    void parallelFor(size_t count, F f) {
+        if (count == 0) return;
+
+        struct Group {
+            std::atomic<size_t> remaining;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto group = std::make_shared<Group>();
+        group->remaining = count;
+
+        const size_t threads = queues.size();
+        for (size_t w = 0; w < threads; ++w) {
+            // Владелец берет задачи с конца, поэтому диапазон кладется в обратном
+            // порядке и выполняется по возрастанию индексов
+            size_t begin = count * w / threads, end = count * (w + 1) / threads;
+            for (size_t i = end; i-- > begin;) {
+                push(w, [group, f, i]() {
+                    try {
+                        f(i);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(group->mutex);
+                        if (!group->error) group->error = std::current_exception();
+                    }
+                    if (group->remaining.fetch_sub(1) == 1) {
+                        std::lock_guard<std::mutex> lock(group->mutex);
+                        group->done.notify_all();
+                    }
+                });
+            }
+        }
+        notifyWorkers();
+
+        // Пока задачи не закончились, ожидающий поток помогает их выполнять
+        size_t self = 0;
+        while (group->remaining.load() > 0) {
+            if (runOne(self)) continue;
+            std::unique_lock<std::mutex> lock(group->mutex);
+            group->done.wait(lock, [&group]() { return group->remaining.load() == 0; });
+        }
+        if (group->error) {
+            std::rethrow_exception(group->error);
+        }
+    }
+};
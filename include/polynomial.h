@@ -10,102 +10,1133 @@
 #include <sstream>  
 #include <limits>   
 #include <cstdlib>  
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <array>
+#include <memory>
+
+#include "TSmallVector.h"
+#include "ModInt.h"
+#include "FFT.h"
+#include "BatchKernels.h"
 
 const int MIN_DEGREE = 0;
 const int MAX_DEGREE = 9;
 const double EPSILON = 1e-9;
 
-struct Monomial {
-    double coeff;
-    int px, py, pz; 
+// Степени монома упаковываются в один ключ: key = px * BASE^2 + py * BASE + pz.
+// Порядок ключей совпадает с лексикографическим порядком (px, py, pz),
+// поэтому сравнение, равенство и хеширование сводятся к одному целому числу.
+const int DEGREE_BASE = MAX_DEGREE + 1;
+const int MONOMIAL_KEY_COUNT = DEGREE_BASE * DEGREE_BASE * DEGREE_BASE;
+
+// Имена переменных по порядку; их число ограничивает NVars
+const char VARIABLE_NAMES[] = "xyzwuvst";
+const int MAX_VARIABLES = sizeof(VARIABLE_NAMES) - 1;
+
+// Наибольшее пространство ключей, для которого используются плотные массивы
+// (накопление при умножении, сложении и нормализации)
+const uint64_t MAX_DENSE_KEY_COUNT = 1 << 16;
+
+constexpr uint64_t keySpaceSize(int base, int vars) {
+    return vars == 0 ? 1 : static_cast<uint64_t>(base) * keySpaceSize(base, vars - 1);
+}
+
+// Раскладка монома: NVars переменных со степенями от 0 до MaxDeg. Степени
+// упаковываются в ключ по основанию MaxDeg + 1 (первая переменная - старший
+// разряд), тип ключа - наименьшее беззнаковое целое, вмещающее все ключи.
+// Поэтому сравнение мономов остается сравнением одного машинного слова, а
+// произведение мономов после проверки степеней - сложением ключей.
+template<int NVars, int MaxDeg>
+struct MonomialLayout {
+    static_assert(NVars >= 1 && NVars <= MAX_VARIABLES, "Число переменных должно быть от 1 до MAX_VARIABLES");
+    static_assert(MaxDeg >= 1, "Наибольшая степень должна быть положительной");
+    static_assert(keySpaceSize(MaxDeg + 1, NVars) / (MaxDeg + 1) <= UINT64_MAX / (MaxDeg + 1) / 2,
+        "Ключ монома не помещается в 64 бита");
+
+    static constexpr int VARIABLES = NVars;
+    static constexpr int MAX_DEGREE = MaxDeg;
+    static constexpr int BASE = MaxDeg + 1;
+    static constexpr uint64_t KEY_COUNT = keySpaceSize(BASE, NVars);
+
+    // Плотные массивы по ключу допустимы только для небольшого пространства ключей
+    static constexpr bool DENSE = KEY_COUNT <= MAX_DENSE_KEY_COUNT;
+    static constexpr int DENSE_SIZE = DENSE ? static_cast<int>(KEY_COUNT) : 0;
+
+    using key_type = typename std::conditional<KEY_COUNT <= 0x10000ULL, uint16_t,
+        typename std::conditional<KEY_COUNT <= 0x100000000ULL, uint32_t, uint64_t>::type>::type;
+
+    // Вес разряда переменной var в ключе
+    static constexpr uint64_t place(int var) {
+        return keySpaceSize(BASE, NVars - 1 - var);
+    }
+
+    static int exponent(uint64_t key, int var) {
+        return static_cast<int>(key / place(var) % BASE);
+    }
+
+    // Все степени монома сразу: деления на константу BASE в разрядности ключа,
+    // начиная с младшего разряда
+    static void exponents(key_type key, int* out) {
+        for (int var = NVars - 1; var >= 0; --var) {
+            out[var] = static_cast<int>(key % BASE);
+            key = static_cast<key_type>(key / BASE);
+        }
+    }
+};
+
+template<int NVars, int MaxDeg> constexpr int MonomialLayout<NVars, MaxDeg>::VARIABLES;
+template<int NVars, int MaxDeg> constexpr int MonomialLayout<NVars, MaxDeg>::MAX_DEGREE;
+template<int NVars, int MaxDeg> constexpr int MonomialLayout<NVars, MaxDeg>::BASE;
+template<int NVars, int MaxDeg> constexpr uint64_t MonomialLayout<NVars, MaxDeg>::KEY_COUNT;
+template<int NVars, int MaxDeg> constexpr bool MonomialLayout<NVars, MaxDeg>::DENSE;
+template<int NVars, int MaxDeg> constexpr int MonomialLayout<NVars, MaxDeg>::DENSE_SIZE;
+
+// Исходная раскладка: x, y, z со степенями 0-9, 1000 ключей
+using DefaultLayout = MonomialLayout<3, MAX_DEGREE>;
+
+// Шаг квантования коэффициентов при хешировании. Полиномы, равные с точностью
+// EPSILON, почти всегда попадают в один шаг; разные хеши возможны только если
+// коэффициенты лежат по разные стороны границы шага.
+const double HASH_COEFF_QUANTUM = 1e-6;
+
+// Допуск сравнения для коэффициентов float
+const float FLOAT_EPSILON = 1e-5f;
+
+// Свойства типа коэффициентов: проверка на ноль, равенство, хеш, разбор
+// числа из строки и знак при выводе. Полином определен для double (основной
+// тип), float, точных int64_t и вычетов ModInt<P>.
+template<class TCoeff>
+struct CoeffTraits;
+
+// Общая часть для чисел с плавающей точкой: сравнение с допуском tolerance
+template<class TFloat>
+struct FloatCoeffTraits {
+    static const bool exact = false;
+
+    static TFloat tolerance() {
+        return std::is_same<TFloat, float>::value ? static_cast<TFloat>(FLOAT_EPSILON) : static_cast<TFloat>(EPSILON);
+    }
+
+    static bool isZero(TFloat c) {
+        return std::abs(c) <= tolerance();
+    }
+
+    static bool equal(TFloat a, TFloat b) {
+        return std::fabs(a - b) < tolerance();
+    }
+
+    static bool isNegative(TFloat c) {
+        return c < 0;
+    }
+
+    static size_t hash(TFloat c) {
+        double quantized = std::round(static_cast<double>(c) / HASH_COEFF_QUANTUM);
+        if (std::abs(quantized) < 9.0e18) {
+            return std::hash<long long>()(static_cast<long long>(quantized));
+        }
+        return std::hash<double>()(static_cast<double>(c));
+    }
+
+    static TFloat parse(const char* str, char** end) {
+        return static_cast<TFloat>(std::strtod(str, end));
+    }
+};
+
+template<>
+struct CoeffTraits<double> : FloatCoeffTraits<double> {};
+
+template<>
+struct CoeffTraits<float> : FloatCoeffTraits<float> {};
+
+template<>
+struct CoeffTraits<int64_t> {
+    static const bool exact = true;
+    static bool isZero(int64_t c) { return c == 0; }
+    static bool equal(int64_t a, int64_t b) { return a == b; }
+    static bool isNegative(int64_t c) { return c < 0; }
+    static size_t hash(int64_t c) { return std::hash<int64_t>()(c); }
+
+    // Точный тип принимает только целые коэффициенты
+    static int64_t parse(const char* str, char** end) {
+        return static_cast<int64_t>(std::strtoll(str, end, 10));
+    }
+};
+
+template<uint64_t P>
+struct CoeffTraits<ModInt<P>> {
+    static const bool exact = true;
+    static bool isZero(const ModInt<P>& c) { return c.value() == 0; }
+    static bool equal(const ModInt<P>& a, const ModInt<P>& b) { return a == b; }
+    static bool isNegative(const ModInt<P>&) { return false; }
+    static size_t hash(const ModInt<P>& c) { return std::hash<uint64_t>()(c.value()); }
+
+    static ModInt<P> parse(const char* str, char** end) {
+        return ModInt<P>(std::strtoll(str, end, 10));
+    }
+};
+
+template<class TCoeff, class TLayout = DefaultLayout>
+struct TMonomial {
+    using Traits = CoeffTraits<TCoeff>;
+    using Layout = TLayout;
+    using key_type = typename TLayout::key_type;
+
+    TCoeff coeff;
+    key_type key; 
+
+    // Степени первых трех переменных (x, y, z); остальные переменные - нулевой степени
+    TMonomial(TCoeff c = TCoeff(), int x = 0, int y = 0, int z = 0) : coeff(c), key(0) {
+        const int exponents[3] = { x, y, z };
+        for (int var = 0; var < 3; ++var) {
+            int limit = var < TLayout::VARIABLES ? TLayout::MAX_DEGREE : 0;
+            if (exponents[var] < MIN_DEGREE || exponents[var] > limit) {
+                throw std::out_of_range(degreeError());
+            }
+            if (var < TLayout::VARIABLES) {
+                key = static_cast<key_type>(key + exponents[var] * TLayout::place(var));
+            }
+        }
+    }
+
+    // Степени всех переменных по порядку
+    TMonomial(TCoeff c, std::initializer_list<int> exponents) : coeff(c), key(0) {
+        if (exponents.size() > static_cast<size_t>(TLayout::VARIABLES)) {
+            throw std::out_of_range(degreeError());
+        }
+        int var = 0;
+        for (int e : exponents) {
+            if (e < MIN_DEGREE || e > TLayout::MAX_DEGREE) {
+                throw std::out_of_range(degreeError());
+            }
+            key = static_cast<key_type>(key + e * TLayout::place(var++));
+        }
+    }
+
+    static std::string degreeError() {
+        return "Степень монома вне допустимого диапазона (0-" + std::to_string(TLayout::MAX_DEGREE) + ").";
+    }
+
+    // Создание монома по уже упакованному ключу (без проверки диапазона)
+    static TMonomial fromKey(TCoeff c, uint64_t k) {
+        TMonomial m(c);
+        m.key = static_cast<key_type>(k);
+        return m;
+    }
+
+    int exponent(int var) const { return TLayout::exponent(key, var); }
+
+    int px() const { return exponent(0); }
+    int py() const { return exponent(1); }
+    int pz() const { return exponent(2); }
 
-    Monomial(double c = 0.0, int x = 0, int y = 0, int z = 0) : coeff(c), px(x), py(y), pz(z) {
-        if (px < MIN_DEGREE || px > MAX_DEGREE ||
-            py < MIN_DEGREE || py > MAX_DEGREE ||
-            pz < MIN_DEGREE || pz > MAX_DEGREE) {
-            throw std::out_of_range("Степень монома вне допустимого диапазона (0-9).");
+    int totalDegree() const {
+        int result = 0;
+        for (int var = 0; var < TLayout::VARIABLES; ++var) {
+            result += exponent(var);
         }
+        return result;
     }
 
-    bool operator<(const Monomial& other) const {
-        if (px != other.px) return px > other.px;
-        if (py != other.py) return py > other.py;
-        if (pz != other.pz) return pz > other.pz;
-        return false; 
+    bool operator<(const TMonomial& other) const {
+        return key > other.key;
     }
 
-    bool operator==(const Monomial& other) const {
-        if (px != other.px || py != other.py || pz != other.pz) {
+    bool operator==(const TMonomial& other) const {
+        if (key != other.key) {
             return false;
         }
-        return std::fabs(coeff - other.coeff) < EPSILON;
+        return Traits::equal(coeff, other.coeff);
     }
 
-    bool EqXYZ(const Monomial& other) const {
-        return px == other.px && py == other.py && pz == other.pz;
+    bool EqXYZ(const TMonomial& other) const {
+        return key == other.key;
     }
 
-    Monomial operator*(const Monomial& other) const {
-        if (px + other.px > MAX_DEGREE ||
-            py + other.py > MAX_DEGREE ||
-            pz + other.pz > MAX_DEGREE) {
-            throw std::out_of_range("Умножение мономов приводит к степеням вне допустимого диапазона (0-9).");
+    TMonomial operator*(const TMonomial& other) const {
+        for (int var = 0; var < TLayout::VARIABLES; ++var) {
+            if (exponent(var) + other.exponent(var) > TLayout::MAX_DEGREE) {
+                throw std::out_of_range("Умножение мономов приводит к степеням вне допустимого диапазона (0-" + std::to_string(TLayout::MAX_DEGREE) + ").");
+            }
         }
-        return { coeff * other.coeff, px + other.px, py + other.py, pz + other.pz };
+        return fromKey(coeff * other.coeff, static_cast<uint64_t>(key) + other.key);
     }
 
-    bool operator!=(const Monomial& other) const {
+    bool operator!=(const TMonomial& other) const {
         return !(*this == other);
     }
 };
 
+using Monomial = TMonomial<double>;
+
+static_assert(sizeof(Monomial) <= 16, "Monomial должен занимать не более 16 байт");
+static_assert(sizeof(TMonomial<float>) <= 8, "Моном с коэффициентом float должен занимать не более 8 байт");
+
+namespace std {
+    template<class TCoeff, class TLayout>
+    struct hash<TMonomial<TCoeff, TLayout>> {
+        size_t operator()(const TMonomial<TCoeff, TLayout>& m) const {
+            return static_cast<size_t>(m.key);
+        }
+    };
+}
+
+
+// Сколько мономов полином хранит без выделения памяти в куче
+const size_t SMALL_TERMS_CAPACITY = 7;
+
+// Список мономов полинома: короткие полиномы хранятся внутри объекта
+template<class TCoeff, class TLayout = DefaultLayout>
+using TTermList = TSmallVector<TMonomial<TCoeff, TLayout>, SMALL_TERMS_CAPACITY>;
+
+using TermList = TTermList<double>;
+
+// Доля заполнения пространства мономов, начиная с которой сумма многих
+// полиномов накапливается в плотном представлении (для двух слагаемых слияние
+// упорядоченных списков за O(n + m) всегда не дороже обхода всех ключей)
+const double DENSE_FILL_RATIO = 0.25;
+
+// Число попарных произведений мономов, начиная с которого умножение
+// накапливается в плотном массиве, а не сливается через кучу
+const size_t DENSE_MULTIPLY_THRESHOLD = MONOMIAL_KEY_COUNT;
+
+// Длина списка мономов, начиная с которой нормализация раскладывает мономы
+// по ключам (сортировка подсчетом) вместо сортировки сравнением
+const size_t BUCKET_CANONICALIZE_THRESHOLD = 32;
+
+// Отношение числа попарных произведений мономов к L log L (L - длина свертки),
+// начиная с которого умножение выполняется через БПФ: по сравнению со слиянием
+// через кучу и с (заметно более дешевым на одно произведение) плотным массивом
+const double FFT_HEAP_RATIO = 1.0;
+const double FFT_DENSE_RATIO = 16.0;
+
+// Наибольший размер таблиц степеней координат (на все переменные), которые
+// вычисление значения полинома держит на стеке
+const int MAX_POWER_TABLE_SIZE = 256;
+
+// Размер строк степеней (число значений на все переменные) для блока точек при
+// пакетном вычислении: около 16 КБ для double, то есть блок остается в кэше L1
+const int BATCH_TABLE_SIZE = 2048;
+
+// Наибольшая длина свертки при умножении через БПФ
+const uint64_t MAX_FFT_LENGTH = 1 << 22;
+
+// Способ умножения полиномов
+enum class MultiplicationKernel {
+    Auto,   // выбор по размеру операндов; БПФ - только если его погрешность
+            // не меняет результат (с точностью EPSILON)
+    Heap,   // слияние через кучу, память O(n)
+    Dense,  // накопление в плотном массиве по ключу монома
+    Fft     // подстановка Кронекера и свертка через БПФ (только double и float;
+            // для точных коэффициентов и слишком длинной свертки - слияние через кучу).
+            // Коэффициенты приближенные: погрешность растет с нормами операндов
+};
+
+// Плотное представление полинома: по одному коэффициенту на каждый из
+// KEY_COUNT возможных мономов, индекс совпадает с ключом монома.
+// Сложение, вычитание и умножение на число - простые циклы по непрерывному
+// массиву фиксированной длины, которые компилятор векторизует. Для раскладок
+// с большим пространством ключей (TLayout::DENSE == false) массив пуст и
+// полином плотные алгоритмы не использует.
+template<class TCoeff, class TLayout = DefaultLayout>
+class TDensePolynomial {
+public:
+    using TermList = TTermList<TCoeff, TLayout>;
+    using DensePolynomial = TDensePolynomial;
+    using coeff_type = TCoeff;
+
+    static constexpr int SIZE = TLayout::DENSE_SIZE;
 
-class Polynomial {
 private:
-    std::vector<Monomial> terms; 
+    using Traits = CoeffTraits<TCoeff>;
+
+    std::vector<TCoeff> coeffs;
+
+public:
+    TDensePolynomial() : coeffs(SIZE, TCoeff()) {}
+
+    template<class TTerms>
+    explicit TDensePolynomial(const TTerms& terms) : TDensePolynomial() {
+        add(terms);
+    }
+
+    // Добавляет (с множителем sign) мономы из разреженного списка
+    template<class TTerms>
+    void add(const TTerms& terms, TCoeff sign = TCoeff(1)) {
+        TCoeff* c = coeffs.data();
+        for (const auto& term : terms) {
+            c[term.key] += sign * term.coeff;
+        }
+    }
+
+    DensePolynomial& operator+=(const DensePolynomial& other) {
+        TCoeff* a = coeffs.data();
+        const TCoeff* b = other.coeffs.data();
+        for (int i = 0; i < SIZE; ++i) {
+            a[i] += b[i];
+        }
+        return *this;
+    }
+
+    DensePolynomial& operator-=(const DensePolynomial& other) {
+        TCoeff* a = coeffs.data();
+        const TCoeff* b = other.coeffs.data();
+        for (int i = 0; i < SIZE; ++i) {
+            a[i] -= b[i];
+        }
+        return *this;
+    }
+
+    DensePolynomial& operator*=(TCoeff constant) {
+        TCoeff* a = coeffs.data();
+        for (int i = 0; i < SIZE; ++i) {
+            a[i] *= constant;
+        }
+        return *this;
+    }
+
+    DensePolynomial operator+(const DensePolynomial& other) const {
+        DensePolynomial result(*this);
+        result += other;
+        return result;
+    }
+
+    DensePolynomial operator-(const DensePolynomial& other) const {
+        DensePolynomial result(*this);
+        result -= other;
+        return result;
+    }
+
+    DensePolynomial operator*(TCoeff constant) const {
+        DensePolynomial result(*this);
+        result *= constant;
+        return result;
+    }
+
+    TCoeff operator[](int key) const {
+        return coeffs[key];
+    }
+
+    TCoeff& operator[](int key) {
+        return coeffs[key];
+    }
+
+    void clear() {
+        std::fill(coeffs.begin(), coeffs.end(), TCoeff());
+    }
+
+    // Сжатие диапазона ключей [low_key, high_key] в канонический список с обнулением
+    // этих ячеек - массив можно сразу использовать повторно
+    TermList extractTerms(int low_key, int high_key) {
+        TermList result;
+        TCoeff* c = coeffs.data();
+        for (int key = high_key; key >= low_key; --key) {
+            if (!Traits::isZero(c[key])) {
+                result.push_back(TMonomial<TCoeff, TLayout>::fromKey(c[key], key));
+            }
+            c[key] = TCoeff();
+        }
+        return result;
+    }
+
+    // Сжатие в канонический разреженный список (по убыванию ключа, без нулей)
+    TermList toTerms() const {
+        TermList result;
+        const TCoeff* c = coeffs.data();
+        for (int key = SIZE - 1; key >= 0; --key) {
+            if (!Traits::isZero(c[key])) {
+                result.push_back(TMonomial<TCoeff, TLayout>::fromKey(c[key], key));
+            }
+        }
+        return result;
+    }
+};
+
+template<class TCoeff, class TLayout> constexpr int TDensePolynomial<TCoeff, TLayout>::SIZE;
+
+using DensePolynomial = TDensePolynomial<double>;
+
+
+template<class E>
+struct PolyExpr;
+
+// Полином с коэффициентами TCoeff над мономами раскладки TLayout (см.
+// MonomialLayout; по умолчанию x, y, z со степенями 0-9)
+template<class TCoeff, class TLayout = DefaultLayout>
+class TPolynomial {
+public:
+    // Внутри шаблона короткие имена обозначают типы с теми же TCoeff и TLayout
+    using Polynomial = TPolynomial;
+    using Monomial = TMonomial<TCoeff, TLayout>;
+    using TermList = TTermList<TCoeff, TLayout>;
+    using DensePolynomial = TDensePolynomial<TCoeff, TLayout>;
+    using Layout = TLayout;
+    using coeff_type = TCoeff;
+    using key_type = typename TLayout::key_type;
+
+    static constexpr int VARIABLES = TLayout::VARIABLES;
+
+private:
+    using Traits = CoeffTraits<TCoeff>;
+
+    // Буфер мономов разделяется между копиями (см. TSmallVector) и копируется
+    // только при изменении. Так как terms объявлен mutable, в const-методах
+    // мономы читаются через константную ссылку (getTerms()), иначе обычное
+    // чтение отделяло бы буфер.
+    //
+    // Полином может находиться в ненормализованном состоянии (после deferredAdd):
+    // мономы тогда просто дописаны в конец, не упорядочены и могут повторяться.
+    // Нормализация выполняется при первом наблюдении значения - сравнении,
+    // getTerms, выводе, копировании в хранилище или арифметике. Поэтому
+    // одновременно читать из разных потоков можно только нормализованный
+    // полином (в хранилища попадают только такие).
+    mutable TermList terms; 
+    mutable bool normalized = true;
+
+    void normalize() const {
+        if (!normalized) {
+            const_cast<Polynomial*>(this)->canonicalize();
+            normalized = true;
+        }
+    }
+
+    // Дописывает мономы other (с множителем sign) без нормализации
+    void appendTerms(const Polynomial& other, TCoeff sign) {
+        // Чтение через константную ссылку не отделяет разделяемый буфер other
+        const TermList& source = other.terms;
+        terms.reserve(terms.size() + source.size());
+        for (const auto& term : source) {
+            terms.push_back(Monomial::fromKey(sign * term.coeff, term.key));
+        }
+        normalized = false;
+    }
+
+    // Приведение к каноническому виду. Если пространство ключей невелико
+    // (Layout::DENSE), длинный список раскладывается по ячейкам плотного массива
+    // (сортировка подсчетом): подобные члены складываются в той же ячейке, а
+    // обход диапазона ключей сразу дает упорядоченный результат - O(n + диапазон
+    // ключей). Короткие списки быстрее отсортировать сравнением.
     void canonicalize() {
         if (terms.empty()) {
             return;
         }
+        if (TLayout::DENSE && terms.size() >= BUCKET_CANONICALIZE_THRESHOLD) {
+            DenseScratch lease;
+            DensePolynomial& scratch = *lease;
+            int low = DensePolynomial::SIZE, high = -1;
+            for (const auto& term : terms) {
+                scratch[term.key] += term.coeff;
+                low = std::min(low, static_cast<int>(term.key));
+                high = std::max(high, static_cast<int>(term.key));
+            }
+            terms = scratch.extractTerms(low, high);
+            return;
+        }
+
         std::sort(terms.begin(), terms.end());
 
-        std::vector<Monomial> canonical_terms;
+        // Слияние подобных членов на месте: last - последний записанный моном
+        Monomial* t = terms.data();
+        size_t last = 0;
+        for (size_t i = 1; i < terms.size(); ++i) {
+            if (t[i].EqXYZ(t[last])) {
+                t[last].coeff += t[i].coeff;
+            }
+            else {
+                if (!Traits::isZero(t[last].coeff)) {
+                    ++last;
+                }
+                t[last] = t[i];
+            }
+        }
+        if (!Traits::isZero(t[last].coeff)) {
+            ++last;
+        }
+        terms.erase(terms.begin() + last, terms.end());
+    }
 
-        canonical_terms.push_back(terms[0]);
+    // Слияние двух канонических списков мономов (b берется с множителем sign) за один проход.
+    // Подобные члены складываются сразу, взаимно уничтожившиеся - отбрасываются.
+    static void mergeTerms(const TermList& a, const TermList& b, TCoeff sign, TermList& out) {
+        out.reserve(a.size() + b.size());
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            if (a[i].key > b[j].key) {
+                out.push_back(a[i++]);
+            }
+            else if (a[i].key < b[j].key) {
+                out.push_back(Monomial::fromKey(sign * b[j].coeff, b[j].key));
+                j++;
+            }
+            else {
+                TCoeff coeff = a[i].coeff + sign * b[j].coeff;
+                if (!Traits::isZero(coeff)) {
+                    out.push_back(Monomial::fromKey(coeff, a[i].key));
+                }
+                i++;
+                j++;
+            }
+        }
+        out.append(a.begin() + i, a.end());
+        for (; j < b.size(); ++j) {
+            out.push_back(Monomial::fromKey(sign * b[j].coeff, b[j].key));
+        }
+    }
 
-        for (size_t i = 1; i < terms.size(); ++i) {
-            if (terms[i].EqXYZ(canonical_terms.back())) {
-                canonical_terms.back().coeff += terms[i].coeff;
+    // Степени произведения складываются, поэтому выход за MAX_DEGREE проверяется
+    // заранее по старшим степеням сомножителей. После проверки ключ произведения
+    // мономов - просто сумма ключей.
+    void checkProductDegree(const Polynomial& other) const {
+        for (int var = 0; var < VARIABLES; ++var) {
+            if (degree(var) + other.degree(var) > TLayout::MAX_DEGREE) {
+                throw std::out_of_range("Ошибка умножения полиномов: " + degreeRangeMessage());
+            }
+        }
+    }
+
+    static std::string degreeRangeMessage() {
+        return "Умножение мономов приводит к степеням вне допустимого диапазона (0-" + std::to_string(TLayout::MAX_DEGREE) + ").";
+    }
+
+    // Умножение слиянием строк через кучу (метод Джонсона): для каждого члена a[i]
+    // в куче лежит очередное произведение a[i] * b[j]. Произведения извлекаются
+    // сразу в каноническом порядке, подобные члены складываются на лету.
+    // Дополнительная память - O(a.size()), без итоговой сортировки.
+    static Polynomial multiplyHeap(const TermList& a, const TermList& b) {
+        struct HeapEntry {
+            uint64_t key;
+            size_t i;
+            size_t j;
+        };
+        auto less_key = [](const HeapEntry& l, const HeapEntry& r) { return l.key < r.key; };
+
+        std::vector<HeapEntry> heap;
+        heap.reserve(a.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            heap.push_back({ static_cast<uint64_t>(a[i].key) + b[0].key, i, 0 });
+        }
+        std::make_heap(heap.begin(), heap.end(), less_key);
+
+        Polynomial result;
+        result.terms.reserve(a.size() + b.size());
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), less_key);
+            HeapEntry& top = heap.back();
+            TCoeff coeff = a[top.i].coeff * b[top.j].coeff;
+
+            if (!result.terms.empty() && result.terms.back().key == top.key) {
+                result.terms.back().coeff += coeff;
             }
             else {
-                canonical_terms.push_back(terms[i]);
+                if (!result.terms.empty() && Traits::isZero(result.terms.back().coeff)) {
+                    result.terms.pop_back();
+                }
+                result.terms.push_back(Monomial::fromKey(coeff, top.key));
             }
+
+            if (++top.j < b.size()) {
+                top.key = static_cast<uint64_t>(a[top.i].key) + b[top.j].key;
+                std::push_heap(heap.begin(), heap.end(), less_key);
+            }
+            else {
+                heap.pop_back();
+            }
+        }
+        if (!result.terms.empty() && Traits::isZero(result.terms.back().coeff)) {
+            result.terms.pop_back();
         }
+        return result;
+    }
+
+    // Плотный массив для накопления: свой у каждого потока и переиспользуется,
+    // extractTerms оставляет его обнуленным. Пока массив занят (например,
+    // выражение нормализует операнд посреди накопления), вложенное
+    // использование получает отдельный временный массив.
+    class DenseScratch {
+    private:
+        std::unique_ptr<DensePolynomial> temporary;
+        DensePolynomial* dense;
 
-        terms.clear(); 
-        for (const auto& term : canonical_terms) {
-            if (std::abs(term.coeff) > EPSILON) {
-                terms.push_back(term); 
+        static bool& busy() {
+            static thread_local bool flag = false;
+            return flag;
+        }
+
+        static DensePolynomial& shared() {
+            static thread_local DensePolynomial scratch;
+            return scratch;
+        }
+
+    public:
+        DenseScratch() {
+            if (busy()) {
+                temporary.reset(new DensePolynomial());
+                dense = temporary.get();
+            }
+            else {
+                busy() = true;
+                dense = &shared();
+            }
+        }
+
+        ~DenseScratch() {
+            if (!temporary) busy() = false;
+        }
+
+        DenseScratch(const DenseScratch&) = delete;
+        DenseScratch& operator=(const DenseScratch&) = delete;
+
+        DensePolynomial& operator*() const {
+            return *dense;
+        }
+    };
+
+    // Полином из списка, который уже канонический (упорядочен, без повторов и
+    // нулей): нормализация не повторяется
+    static Polynomial fromCanonical(TermList&& sorted) {
+        Polynomial result;
+        result.terms = std::move(sorted);
+        return result;
+    }
+
+    template<class E>
+    friend typename E::polynomial_type evaluateExpr(const PolyExpr<E>& expr, std::true_type);
+    template<class P>
+    friend P sumMerge(const std::vector<const P*>& polys);
+    template<class P>
+    friend P sumDense(const std::vector<const P*>& polys);
+
+    // Умножение накоплением в плотный массив: все ключи произведения лежат в
+    // [0, KEY_COUNT), поэтому ни временный вектор из n*m мономов, ни
+    // сортировка не нужны. Только для раскладок с Layout::DENSE.
+    static Polynomial multiplyDense(const TermList& a, const TermList& b) {
+        DenseScratch lease;
+        DensePolynomial& scratch = *lease;
+        for (const auto& term1 : a) {
+            for (const auto& term2 : b) {
+                scratch[term1.key + term2.key] += term1.coeff * term2.coeff;
+            }
+        }
+        Polynomial result;
+        result.terms = scratch.extractTerms(a.back().key + b.back().key, a.front().key + b.front().key);
+        return result;
+    }
+
+    // Оценка сверху абсолютной погрешности коэффициентов произведения через БПФ
+    // длины length: порядка eps * log L * |a| * |b| (нормы векторов коэффициентов).
+    // На практике фактическая погрешность примерно в сто раз меньше.
+    static double fftErrorBound(const TermList& a, const TermList& b, uint64_t length) {
+        double a_norm = 0, b_norm = 0;
+        for (const auto& term : a) {
+            a_norm += static_cast<double>(term.coeff) * term.coeff;
+        }
+        for (const auto& term : b) {
+            b_norm += static_cast<double>(term.coeff) * term.coeff;
+        }
+        return 4 * std::numeric_limits<double>::epsilon()
+            * std::log2(static_cast<double>(length) + 1) * std::sqrt(a_norm * b_norm);
+    }
+
+    // Умножение подстановкой Кронекера: ключ монома - показатель степени одной
+    // переменной t, а после проверки степеней сумма ключей не дает переносов
+    // между разрядами. Поэтому произведение - свертка коэффициентов, разложенных
+    // по ключам от младшего ключа операнда, которая считается через БПФ за
+    // O(L log L), где L - сумма диапазонов ключей. Значения в пределах
+    // погрешности БПФ (fftErrorBound) считаются нулями.
+    static Polynomial multiplyFft(const TermList& a, const TermList& b, std::true_type /*floating*/) {
+        const uint64_t a_low = a.back().key, b_low = b.back().key;
+        std::vector<double> a_coeffs(static_cast<size_t>(a.front().key - a_low + 1));
+        std::vector<double> b_coeffs(static_cast<size_t>(b.front().key - b_low + 1));
+        for (const auto& term : a) {
+            a_coeffs[static_cast<size_t>(term.key - a_low)] = static_cast<double>(term.coeff);
+        }
+        for (const auto& term : b) {
+            b_coeffs[static_cast<size_t>(term.key - b_low)] = static_cast<double>(term.coeff);
+        }
+
+        std::vector<double> product = convolve(a_coeffs, b_coeffs);
+        const double noise = fftErrorBound(a, b, fftLength(product.size()));
+
+        Polynomial result;
+        for (size_t i = product.size(); i-- > 0;) {
+            if (std::abs(product[i]) <= noise) continue;
+            TCoeff coeff = static_cast<TCoeff>(product[i]);
+            if (!Traits::isZero(coeff)) {
+                result.terms.push_back(Monomial::fromKey(coeff, a_low + b_low + i));
+            }
+        }
+        return result;
+    }
+
+    // Точные коэффициенты через БПФ не умножаются
+    static Polynomial multiplyFft(const TermList& a, const TermList& b, std::false_type /*floating*/) {
+        return a.size() <= b.size() ? multiplyHeap(a, b) : multiplyHeap(b, a);
+    }
+
+    // Длина свертки при умножении через БПФ или 0, если она больше MAX_FFT_LENGTH.
+    // Мономы читаются через константные ссылки, чтобы не отделять разделяемые буферы.
+    static uint64_t fftProductLength(const TermList& a, const TermList& b) {
+        uint64_t a_span = static_cast<uint64_t>(a.front().key) - a.back().key + 1;
+        uint64_t b_span = static_cast<uint64_t>(b.front().key) - b.back().key + 1;
+        if (a_span > MAX_FFT_LENGTH || b_span > MAX_FFT_LENGTH) return 0;
+        uint64_t length = fftLength(static_cast<size_t>(a_span + b_span - 1));
+        return length <= MAX_FFT_LENGTH ? length : 0;
+    }
+
+    // Точность БПФ достаточна для выбора по умолчанию: погрешность и отброшенные
+    // как шум значения равны нулю с точностью EPSILON, то есть результат равен
+    // результату точного слияния (operator==)
+    static bool isFftAccurate(const TermList& a, const TermList& b, uint64_t length, std::true_type /*floating*/) {
+        return 2 * fftErrorBound(a, b, length) <= EPSILON;
+    }
+
+    static bool isFftAccurate(const TermList&, const TermList&, uint64_t, std::false_type /*floating*/) {
+        return false;
+    }
+
+    // Выбирать ли БПФ по умолчанию: свертка длины L стоит порядка L log L
+    // операций, поэлементное умножение - n * m, и погрешность БПФ не меняет
+    // результат. Иначе БПФ используется только по явному запросу.
+    bool isFftCandidate(const Polynomial& other) const {
+        if (Traits::exact) return false;
+        const TermList& a = terms;
+        const TermList& b = other.terms;
+        uint64_t length = fftProductLength(a, b);
+        if (length == 0) return false;
+        double products = static_cast<double>(a.size()) * b.size();
+        double ratio = TLayout::DENSE ? FFT_DENSE_RATIO : FFT_HEAP_RATIO;
+        return products >= ratio * length * std::log2(static_cast<double>(length))
+            && isFftAccurate(a, b, length, std::integral_constant<bool, !Traits::exact>());
+    }
+
+    static constexpr bool POWER_TABLE = VARIABLES * TLayout::BASE <= MAX_POWER_TABLE_SIZE;
+
+    // Степени координат точки: при небольшой наибольшей степени - таблицы
+    // x^0..x^MAX_DEGREE по каждой переменной, вычисленные один раз, иначе -
+    // возведение в степень при запросе
+    class PowerTable {
+    private:
+        TCoeff table[POWER_TABLE ? VARIABLES * TLayout::BASE : 1];
+        const TCoeff* point;
+
+    public:
+        explicit PowerTable(const TCoeff* coords) : point(coords) {
+            for (int var = 0; POWER_TABLE && var < VARIABLES; ++var) {
+                TCoeff* row = table + (POWER_TABLE ? var * TLayout::BASE : 0);
+                row[0] = TCoeff(1);
+                for (int e = 1; e <= TLayout::MAX_DEGREE; ++e) {
+                    row[e] = row[e - 1] * coords[var];
+                }
             }
         }
+
+        TCoeff operator()(int var, int e) const {
+            return POWER_TABLE ? table[POWER_TABLE ? var * TLayout::BASE + e : 0] : power(point[var], e);
+        }
+    };
+
+    // Возведение в степень e >= 0 повторным возведением в квадрат
+    static TCoeff power(TCoeff base, int e) {
+        TCoeff result = TCoeff(1);
+        while (e > 0) {
+            if (e & 1) result = result * base;
+            e >>= 1;
+            if (e > 0) base = base * base;
+        }
+        return result;
     }
 
+    // Число точек в блоке пакетного вычисления (кратно 8 - ширине AVX-512)
+    static constexpr int BATCH_BLOCK = POWER_TABLE ? BATCH_TABLE_SIZE / (VARIABLES * TLayout::BASE) / 8 * 8 : 1;
+
+    // Строки степеней блока из count точек, начиная с start:
+    // table[(var * BASE + e) * BATCH_BLOCK + j] = coords[var][start + j]^e для e <= top[var]
+    static void fillPowerRows(const TCoeff* const* coords, size_t start, size_t count, const int* top, TCoeff* table) {
+        for (int var = 0; var < VARIABLES; ++var) {
+            const TCoeff* c = coords[var] + start;
+            TCoeff* first = table + var * TLayout::BASE * BATCH_BLOCK;
+            std::fill(first, first + count, TCoeff(1));
+            for (int power = 1; power <= top[var]; ++power) {
+                const TCoeff* prev = first + (power - 1) * BATCH_BLOCK;
+                TCoeff* cur = first + power * BATCH_BLOCK;
+                for (size_t j = 0; j < count; ++j) {
+                    cur[j] = prev[j] * c[j];
+                }
+            }
+        }
+    }
+
+    // Пакетное вычисление блоками: для каждого блока строятся строки степеней
+    // row(var, e)[j] = coords[var][j]^e (до старшей степени полинома по var),
+    // затем каждый моном добавляет свой вклад во все точки блока
+    // (accumulateTerm). Строки нулевых степеней (все единицы) не умножаются.
+    void evaluateBlocks(const TCoeff* const* coords, TCoeff* out, size_t n, std::true_type /*power table*/) const {
+        const TermList& sorted = getTerms();
+        alignas(64) TCoeff table[VARIABLES * TLayout::BASE * BATCH_BLOCK];
+        auto row = [&table](int var, int e) { return table + (var * TLayout::BASE + e) * BATCH_BLOCK; };
+        int e[VARIABLES];
+        int top[VARIABLES];
+        const TCoeff* rows[VARIABLES];
+        for (int var = 0; var < VARIABLES; ++var) {
+            top[var] = degree(var);
+        }
+
+        for (size_t start = 0; start < n; start += BATCH_BLOCK) {
+            const size_t count = std::min<size_t>(BATCH_BLOCK, n - start);
+            fillPowerRows(coords, start, count, top, table);
+
+            TCoeff* block_out = out + start;
+            std::fill(block_out, block_out + count, TCoeff());
+            for (const auto& term : sorted) {
+                TLayout::exponents(term.key, e);
+                int used = 0;
+                for (int var = 0; var < VARIABLES; ++var) {
+                    if (e[var] > 0) rows[used++] = row(var, e[var]);
+                }
+                if (used == 0) rows[used++] = row(0, 0);
+                accumulateTerm(term.coeff, rows, used, block_out, count);
+            }
+        }
+    }
+
+    // Без таблиц степеней (большие степени) - по одной точке
+    void evaluateBlocks(const TCoeff* const* coords, TCoeff* out, size_t n, std::false_type /*power table*/) const {
+        std::array<TCoeff, VARIABLES> point;
+        for (size_t j = 0; j < n; ++j) {
+            for (int var = 0; var < VARIABLES; ++var) {
+                point[var] = coords[var][j];
+            }
+            out[j] = evaluate(point);
+        }
+    }
+
+    // Значение, производные и (если hessians != nullptr) вторые производные
+    // блоками точек. Строки степеней блока общие для всех величин: производная
+    // монома по a - тот же моном с коэффициентом coeff * e[a] и строкой
+    // степени e[a] - 1 вместо e[a]. Вычисляется только верхний треугольник
+    // матрицы Гессе, нижний копируется в конце блока.
+    void derivativeBlocks(const TCoeff* const* coords, TCoeff* values, TCoeff* gradients, TCoeff* hessians,
+        size_t n, std::true_type /*power table*/) const {
+        const TermList& sorted = getTerms();
+        alignas(64) TCoeff table[VARIABLES * TLayout::BASE * BATCH_BLOCK];
+        int e[VARIABLES];
+        int shifted[VARIABLES];
+        int top[VARIABLES];
+        const TCoeff* rows[VARIABLES];
+        for (int var = 0; var < VARIABLES; ++var) {
+            top[var] = degree(var);
+        }
+        // Моном с показателями exps (для блока из count точек) прибавляется к out
+        auto accumulate = [&table, &rows](TCoeff coeff, const int* exps, TCoeff* out, size_t count) {
+            int used = 0;
+            for (int var = 0; var < VARIABLES; ++var) {
+                if (exps[var] > 0) rows[used++] = table + (var * TLayout::BASE + exps[var]) * BATCH_BLOCK;
+            }
+            if (used == 0) rows[used++] = table;
+            accumulateTerm(coeff, rows, used, out, count);
+        };
+
+        for (size_t start = 0; start < n; start += BATCH_BLOCK) {
+            const size_t count = std::min<size_t>(BATCH_BLOCK, n - start);
+            fillPowerRows(coords, start, count, top, table);
+
+            std::fill(values + start, values + start + count, TCoeff());
+            for (int a = 0; a < VARIABLES; ++a) {
+                std::fill(gradients + a * n + start, gradients + a * n + start + count, TCoeff());
+                for (int b = a; hessians && b < VARIABLES; ++b) {
+                    TCoeff* h = hessians + (a * VARIABLES + b) * n + start;
+                    std::fill(h, h + count, TCoeff());
+                }
+            }
+
+            for (const auto& term : sorted) {
+                TLayout::exponents(term.key, e);
+                accumulate(term.coeff, e, values + start, count);
+                std::copy(e, e + VARIABLES, shifted);
+                for (int a = 0; a < VARIABLES; ++a) {
+                    if (e[a] == 0) continue;
+                    const TCoeff first = term.coeff * TCoeff(e[a]);
+                    shifted[a] = e[a] - 1;
+                    accumulate(first, shifted, gradients + a * n + start, count);
+                    for (int b = a; hessians && b < VARIABLES; ++b) {
+                        if (shifted[b] == 0) continue;
+                        TCoeff* h = hessians + (a * VARIABLES + b) * n + start;
+                        const int eb = shifted[b];
+                        shifted[b] = eb - 1;
+                        accumulate(first * TCoeff(eb), shifted, h, count);
+                        shifted[b] = eb;
+                    }
+                    shifted[a] = e[a];
+                }
+            }
+
+            for (int a = 0; hessians && a < VARIABLES; ++a) {
+                for (int b = a + 1; b < VARIABLES; ++b) {
+                    const TCoeff* upper = hessians + (a * VARIABLES + b) * n + start;
+                    std::copy(upper, upper + count, hessians + (b * VARIABLES + a) * n + start);
+                }
+            }
+        }
+    }
+
+    // Без таблиц степеней (большие степени) - по одной точке через
+    // полиномы производных, вычисленные один раз
+    void derivativeBlocks(const TCoeff* const* coords, TCoeff* values, TCoeff* gradients, TCoeff* hessians,
+        size_t n, std::false_type /*power table*/) const {
+        std::vector<Polynomial> first(VARIABLES), second(hessians ? VARIABLES * VARIABLES : 0);
+        for (int a = 0; a < VARIABLES; ++a) {
+            first[a] = derivative(a);
+            for (int b = 0; hessians && b < VARIABLES; ++b) {
+                second[a * VARIABLES + b] = b < a ? second[b * VARIABLES + a] : first[a].derivative(b);
+            }
+        }
+        std::array<TCoeff, VARIABLES> point;
+        for (size_t j = 0; j < n; ++j) {
+            for (int var = 0; var < VARIABLES; ++var) {
+                point[var] = coords[var][j];
+            }
+            values[j] = evaluate(point);
+            for (int a = 0; a < VARIABLES; ++a) {
+                gradients[a * n + j] = first[a].evaluate(point);
+            }
+            for (size_t k = 0; k < second.size(); ++k) {
+                hessians[k * n + j] = second[k].evaluate(point);
+            }
+        }
+    }
+
+    // Сумма мономов по таблицам степеней; два накопителя, чтобы соседние
+    // мономы не ждали сложения друг друга
+    static TCoeff sumTerms(const TermList& sorted, const PowerTable& powers) {
+        TCoeff even = TCoeff(), odd = TCoeff();
+        int e[VARIABLES];
+        size_t i = 0;
+        for (; i + 1 < sorted.size(); i += 2) {
+            even += termValue(sorted[i], powers, e);
+            odd += termValue(sorted[i + 1], powers, e);
+        }
+        if (i < sorted.size()) {
+            even += termValue(sorted[i], powers, e);
+        }
+        return even + odd;
+    }
+
+    static TCoeff termValue(const Monomial& term, const PowerTable& powers, int* e) {
+        TLayout::exponents(term.key, e);
+        TCoeff value = term.coeff;
+        for (int var = 0; var < VARIABLES; ++var) {
+            value = value * powers(var, e[var]);
+        }
+        return value;
+    }
+
+    // Многомерная схема Горнера по каноническому порядку мономов: внутри группы
+    // мономов с общими степенями старших переменных значение накапливается по
+    // младшей переменной, готовая группа одним умножением переходит на уровень
+    // выше. Степени нужны только для разностей соседних показателей.
+    static TCoeff evaluateHorner(const TermList& sorted, const PowerTable& powers) {
+        TCoeff acc[VARIABLES] = {};
+        int last[VARIABLES];      // показатель последнего значения на уровне, -1 - уровень пуст
+        int current[VARIABLES] = {};
+        int previous[VARIABLES] = {};
+        std::fill(last, last + VARIABLES, -1);
+
+        auto add = [&](int level, TCoeff value, int exponent) {
+            acc[level] = last[level] < 0 ? value : acc[level] * powers(level, last[level] - exponent) + value;
+            last[level] = exponent;
+        };
+        auto close = [&](int level) {
+            TCoeff value = acc[level] * powers(level, last[level]);
+            last[level] = -1;
+            return value;
+        };
+
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            TLayout::exponents(sorted[i].key, current);
+            if (i > 0) {
+                // Ключи различны, поэтому уровень первого отличия меньше VARIABLES
+                int level = 0;
+                while (current[level] == previous[level]) ++level;
+                for (int k = VARIABLES - 1; k > level; --k) {
+                    add(k - 1, close(k), previous[k - 1]);
+                }
+            }
+            add(VARIABLES - 1, sorted[i].coeff, current[VARIABLES - 1]);
+            std::copy(current, current + VARIABLES, previous);
+        }
+        for (int k = VARIABLES - 1; k > 0; --k) {
+            add(k - 1, close(k), previous[k - 1]);
+        }
+        return close(0);
+    }
+
+    // Прибавление канонического списка b (с множителем sign) прямо в terms: слияние
+    // идет с конца, поэтому запись никогда не обгоняет чтение. Новая память
+    // выделяется только при нехватке емкости, и емкость растет геометрически,
+    // так что накопление суммы дает амортизированно O(1) выделений на шаг.
+    void addInPlace(const TermList& b, TCoeff sign) {
+        if (b.empty()) return;
+        ptrdiff_t i = static_cast<ptrdiff_t>(terms.size()) - 1;
+        ptrdiff_t j = static_cast<ptrdiff_t>(b.size()) - 1;
+        terms.resize(terms.size() + b.size());
+        ptrdiff_t w = static_cast<ptrdiff_t>(terms.size()) - 1;
+        Monomial* t = terms.data();
+
+        while (j >= 0) {
+            if (i >= 0 && t[i].key < b[j].key) {
+                t[w--] = t[i--];
+            }
+            else if (i < 0 || t[i].key > b[j].key) {
+                t[w--] = Monomial::fromKey(sign * b[j].coeff, b[j].key);
+                j--;
+            }
+            else {
+                TCoeff coeff = t[i].coeff + sign * b[j].coeff;
+                if (!Traits::isZero(coeff)) {
+                    t[w--] = Monomial::fromKey(coeff, t[i].key);
+                }
+                i--;
+                j--;
+            }
+        }
+        if (w > i) {
+            terms.erase(terms.begin() + (i + 1), terms.begin() + (w + 1));
+        }
+    }
 
 public:
-    Polynomial() {}
+    TPolynomial() {}
+
+    TPolynomial(const std::vector<Monomial>& mono_list) : terms(mono_list.begin(), mono_list.end()) {
+        canonicalize(); 
+    }
 
-    Polynomial(std::vector<Monomial> mono_list) : terms(std::move(mono_list)) {
+    explicit TPolynomial(TermList mono_list) : terms(std::move(mono_list)) {
         canonicalize(); 
     }
 
-    Polynomial(const Polynomial& other) = default;
+    explicit TPolynomial(const DensePolynomial& dense) : terms(dense.toTerms()) {}
 
-    ~Polynomial() = default;
+    // Копия всегда нормализована: при копировании в хранилище источник нормализуется
+    TPolynomial(const Polynomial& other) : terms((other.normalize(), other.terms)) {}
+    TPolynomial(Polynomial&& other) noexcept = default;
 
-    Polynomial& operator=(const Polynomial& other) = default;
-    Polynomial& operator=(Polynomial&& other) = default;
+    ~TPolynomial() = default;
+
+    Polynomial& operator=(const Polynomial& other) {
+        if (this != &other) {
+            other.normalize();
+            terms = other.terms;
+            normalized = true;
+        }
+        return *this;
+    }
+    Polynomial& operator=(Polynomial&& other) noexcept = default;
 
     bool operator==(const Polynomial& other) const {
+        normalize();
+        other.normalize();
         if (this->terms == other.terms) return true;
         return false;
     }
@@ -115,94 +1146,408 @@ public:
         return !(*this == other);
     }
 
-    Polynomial operator+(const Polynomial& other) const {
+    // Отложенное сложение: мономы дописываются за O(other), нормализация - при
+    // наблюдении. Пока полином не нормализован, += и -= тоже откладываются.
+    Polynomial& deferredAdd(const Polynomial& other) {
+        if (&other == this) {
+            return *this *= TCoeff(2);
+        }
+        appendTerms(other, TCoeff(1));
+        return *this;
+    }
+
+    Polynomial& deferredSubtract(const Polynomial& other) {
+        if (&other == this) {
+            terms.clear();
+            normalized = true;
+            return *this;
+        }
+        appendTerms(other, TCoeff(-1));
+        return *this;
+    }
+
+    bool isNormalized() const {
+        return normalized;
+    }
+
+    Polynomial& operator+=(const Polynomial& other) {
+        if (!normalized) {
+            return deferredAdd(other);
+        }
+        if (&other == this) {
+            return *this *= TCoeff(2);
+        }
+        other.normalize();
+        addInPlace(other.terms, TCoeff(1));
+        return *this;
+    }
+
+    Polynomial& operator-=(const Polynomial& other) {
+        if (!normalized) {
+            return deferredSubtract(other);
+        }
+        if (&other == this) {
+            terms.clear();
+            return *this;
+        }
+        other.normalize();
+        addInPlace(other.terms, TCoeff(-1));
+        return *this;
+    }
+
+    Polynomial& operator*=(const Polynomial& other) {
+        *this = multiply(other);
+        return *this;
+    }
+
+    Polynomial& operator*=(TCoeff constant) {
+        if (Traits::isZero(constant)) {
+            terms.clear();
+            normalized = true;
+            return *this;
+        }
+        for (auto& term : terms) {
+            term.coeff *= constant;
+        }
+        if (!normalized) {
+            return *this;
+        }
+        terms.erase(std::remove_if(terms.begin(), terms.end(),
+            [](const Monomial& term) { return Traits::isZero(term.coeff); }), terms.end());
+        return *this;
+    }
+
+    Polynomial operator+(const Polynomial& other) const & {
+        normalize();
+        other.normalize();
         Polynomial result;
-        result.terms.reserve(terms.size() + other.terms.size());
-        result.terms.insert(result.terms.end(), terms.begin(), terms.end());
-        result.terms.insert(result.terms.end(), other.terms.begin(), other.terms.end());
-        result.canonicalize();
+        mergeTerms(terms, other.terms, TCoeff(1), result.terms);
         return result; 
     }
 
-    Polynomial operator-(const Polynomial& other) const {
+    // Перегрузки для временных операндов: результат строится в буфере
+    // операнда, который все равно будет уничтожен
+    Polynomial operator+(const Polynomial& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
+    Polynomial operator+(Polynomial&& other) const & {
+        other += *this;
+        return std::move(other);
+    }
+
+    Polynomial operator+(Polynomial&& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
+    Polynomial operator-(const Polynomial& other) const & {
+        normalize();
+        other.normalize();
         Polynomial result;
-        result.terms.reserve(terms.size() + other.terms.size());
-        result.terms.insert(result.terms.end(), terms.begin(), terms.end());
-        for (const auto& term : other.terms) {
-            result.terms.push_back({ -term.coeff, term.px, term.py, term.pz });
-        }
-        result.canonicalize();
+        mergeTerms(terms, other.terms, TCoeff(-1), result.terms);
         return result; 
     }
 
+    Polynomial operator-(const Polynomial& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
+    Polynomial operator-(Polynomial&& other) const & {
+        other *= TCoeff(-1);
+        other += *this;
+        return std::move(other);
+    }
+
+    Polynomial operator-(Polynomial&& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
     Polynomial operator*(const Polynomial& other) const {
-        Polynomial result;
+        return multiply(other);
+    }
+
+    Polynomial multiply(const Polynomial& other, MultiplicationKernel kernel = MultiplicationKernel::Auto) const {
+        normalize();
+        other.normalize();
         if (terms.empty() || other.terms.empty()) return Polynomial(); 
-        result.terms.reserve(terms.size() * other.terms.size()); 
-
-        for (const auto& term1 : terms) {
-            if (std::abs(term1.coeff) < EPSILON) continue;
-            for (const auto& term2 : other.terms) {
-                if (std::abs(term2.coeff) < EPSILON) continue;
-                try {
-                    result.terms.push_back(term1 * term2); 
-                }
-                catch (const std::out_of_range& e) {
+        checkProductDegree(other);
+        if (kernel == MultiplicationKernel::Auto && isFftCandidate(other)) {
+            kernel = MultiplicationKernel::Fft;
+        }
+        if (kernel == MultiplicationKernel::Fft) {
+            if (!Traits::exact && fftProductLength(terms, other.terms) != 0) {
+                return multiplyFft(terms, other.terms, std::integral_constant<bool, !Traits::exact>());
+            }
+            kernel = MultiplicationKernel::Heap;
+        }
+        if (kernel == MultiplicationKernel::Auto) {
+            // Порог растет пропорционально пространству ключей раскладки
+            const size_t threshold = DENSE_MULTIPLY_THRESHOLD * DensePolynomial::SIZE / MONOMIAL_KEY_COUNT;
+            kernel = TLayout::DENSE && terms.size() * other.terms.size() >= threshold
+                ? MultiplicationKernel::Dense : MultiplicationKernel::Heap;
+        }
+        // Без плотного массива (большое пространство ключей) остается слияние через кучу
+        if (kernel == MultiplicationKernel::Dense && TLayout::DENSE) {
+            return multiplyDense(terms, other.terms);
+        }
+        if (terms.size() <= other.terms.size()) {
+            return multiplyHeap(terms, other.terms);
+        }
+        return multiplyHeap(other.terms, terms);
+    }
+
+    // Усеченное умножение для рядов: мономы произведения со степенью больше
+    // MAX_DEGREE по какой-либо переменной (а если max_total_degree >= 0, то и с
+    // суммарной степенью больше max_total_degree) отбрасываются без исключения.
+    // Мономы other упорядочены по убыванию степени первой переменной, поэтому
+    // слишком старшие по ней образуют префикс и пропускаются целиком бинарным поиском.
+    Polynomial multiplyTruncated(const Polynomial& other, int max_total_degree = -1) const {
+        normalize();
+        other.normalize();
+        Polynomial result;
+        if (terms.empty() || other.terms.empty()) return result;
+
+        const TermList& a = terms;
+        const TermList& b = other.terms;
+        DenseScratch lease;
+        DensePolynomial& scratch = *lease;
+        int low = DensePolynomial::SIZE, high = -1;
+        for (const auto& term1 : a) {
+            int degree1 = term1.totalDegree();
+            if (max_total_degree >= 0 && degree1 > max_total_degree) continue;
 
-                    throw std::out_of_range("Ошибка умножения полиномов: " + std::string(e.what()));
+            uint64_t key_limit = static_cast<uint64_t>(TLayout::MAX_DEGREE - term1.exponent(0) + 1) * TLayout::place(0);
+            auto first = std::partition_point(b.begin(), b.end(),
+                [key_limit](const Monomial& m) { return m.key >= key_limit; });
+            for (auto it = first; it != b.end(); ++it) {
+                bool fits = true;
+                for (int var = 1; var < VARIABLES && fits; ++var) {
+                    fits = term1.exponent(var) + it->exponent(var) <= TLayout::MAX_DEGREE;
+                }
+                if (!fits) continue;
+                if (max_total_degree >= 0 && degree1 + it->totalDegree() > max_total_degree) continue;
+                uint64_t key = static_cast<uint64_t>(term1.key) + it->key;
+                if (TLayout::DENSE) {
+                    scratch[static_cast<int>(key)] += term1.coeff * it->coeff;
+                    low = std::min(low, static_cast<int>(key));
+                    high = std::max(high, static_cast<int>(key));
+                }
+                else {
+                    result.terms.push_back(Monomial::fromKey(term1.coeff * it->coeff, key));
                 }
             }
         }
-        result.canonicalize(); 
-        return result; 
+        if (!TLayout::DENSE) {
+            result.canonicalize();
+        }
+        else if (high >= 0) {
+            result.terms = scratch.extractTerms(low, high);
+        }
+        return result;
+    }
+
+    // Возведение в степень k >= 0 методом повторного возведения в квадрат:
+    // O(log k) умножений вместо k - 1. Степени проверяются до начала вычислений,
+    // поэтому промежуточные произведения не выходят за MAX_DEGREE.
+    Polynomial pow(int k) const {
+        if (k < 0) {
+            throw std::runtime_error("Ошибка возведения в степень: Показатель степени должен быть неотрицательным.");
+        }
+        normalize();
+        if (k == 0) return Polynomial({ Monomial(TCoeff(1), 0, 0, 0) });
+        if (terms.empty()) return Polynomial();
+        for (int var = 0; var < VARIABLES; ++var) {
+            if (static_cast<long long>(k) * degree(var) > TLayout::MAX_DEGREE) {
+                throw std::out_of_range("Ошибка возведения в степень: Результат имеет степени вне допустимого диапазона (0-" + std::to_string(TLayout::MAX_DEGREE) + ").");
+            }
+        }
+
+        Polynomial base = *this;
+        Polynomial result;
+        bool has_result = false;
+        while (true) {
+            if (k & 1) {
+                result = has_result ? result * base : base;
+                has_result = true;
+            }
+            k >>= 1;
+            if (k == 0) break;
+            base = base * base;
+        }
+        return result;
     }
 
-    Polynomial operator*(double constant) const {
+    Polynomial operator*(TCoeff constant) const & {
+        normalize();
         Polynomial result;
-        if (std::abs(constant) < EPSILON) return Polynomial(); 
+        if (Traits::isZero(constant)) return Polynomial(); 
 
+        // Умножение на число не меняет ключей, поэтому порядок мономов сохраняется
         result.terms.reserve(terms.size());
-        for (const auto& term : terms) {
-            if (std::abs(term.coeff) > EPSILON) {
-                result.terms.push_back({ term.coeff * constant, term.px, term.py, term.pz });
+        for (const auto& term : getTerms()) {
+            TCoeff coeff = term.coeff * constant;
+            if (!Traits::isZero(coeff)) {
+                result.terms.push_back(Monomial::fromKey(coeff, term.key));
             }
         }
-        result.canonicalize(); 
         return result; 
     }
 
-    friend std::ostream& operator<<(std::ostream& ostr, const Polynomial& poly);
-    friend std::istream& operator>>(std::istream& istr, Polynomial& poly);
+    Polynomial operator*(TCoeff constant) && {
+        *this *= constant;
+        return std::move(*this);
+    }
 
-    const std::vector<Monomial>& getTerms() const {
+    const TermList& getTerms() const {
+        normalize();
         return terms;
     }
+
+    // Значение полинома в точке (координаты по порядку переменных раскладки).
+    // Степени координат вычисляются один раз (см. PowerTable). При таблицах на
+    // стеке значение - сумма произведений коэффициента на табличные степени:
+    // мономы не зависят друг от друга, поэтому цикл упирается в пропускную
+    // способность умножений, а не в их задержку. Для больших степеней - схема
+    // Горнера. Память не выделяется.
+    TCoeff evaluate(const std::array<TCoeff, VARIABLES>& point) const {
+        const TermList& sorted = getTerms();
+        if (sorted.empty()) return TCoeff();
+        PowerTable powers(point.data());
+        return POWER_TABLE ? sumTerms(sorted, powers) : evaluateHorner(sorted, powers);
+    }
+
+    // Значения полинома в n точках: coords[var][j] - координата var точки j,
+    // результат в out[j]. Внешний цикл идет по мономам, внутренний - по блоку
+    // точек, который обрабатывается векторными инструкциями (см. BatchKernels.h).
+    void evaluateBatch(const std::array<const TCoeff*, VARIABLES>& coords, TCoeff* out, size_t n) const {
+        evaluateBlocks(coords.data(), out, n, std::integral_constant<bool, POWER_TABLE>());
+    }
+
+    // Пакетное вычисление для раскладок не более чем с тремя переменными;
+    // лишние массивы координат не читаются
+    void evaluateBatch(const TCoeff* xs, const TCoeff* ys, const TCoeff* zs, TCoeff* out, size_t n) const {
+        static_assert(VARIABLES <= 3, "Для раскладок с большим числом переменных координаты передаются массивом");
+        const TCoeff* all[3] = { xs, ys, zs };
+        std::array<const TCoeff*, VARIABLES> coords;
+        std::copy(all, all + VARIABLES, coords.begin());
+        evaluateBatch(coords, out, n);
+    }
+
+    // Значение в точке (x, y, z) для раскладок не более чем с тремя переменными
+    TCoeff evaluate(TCoeff x, TCoeff y = TCoeff(), TCoeff z = TCoeff()) const {
+        static_assert(VARIABLES <= 3, "Для раскладок с большим числом переменных точка передается массивом");
+        const TCoeff coords[3] = { x, y, z };
+        std::array<TCoeff, VARIABLES> point;
+        std::copy(coords, coords + VARIABLES, point.begin());
+        return evaluate(point);
+    }
+
+    // Значения, градиенты и (если hessians != nullptr) матрицы Гессе в n точках
+    // за один проход по мономам с общими таблицами степеней - вместо отдельных
+    // вычислений полинома и его производных. Результаты хранятся по компонентам
+    // (как координаты): values[j] - значение в точке j, gradients[a * n + j] -
+    // производная по переменной a, hessians[(a * VARIABLES + b) * n + j] -
+    // вторая производная по a и b (матрица заполняется целиком). Массив
+    // gradients содержит VARIABLES * n значений, hessians - VARIABLES^2 * n.
+    void evaluateDerivativesBatch(const std::array<const TCoeff*, VARIABLES>& coords, TCoeff* values,
+        TCoeff* gradients, TCoeff* hessians, size_t n) const {
+        derivativeBlocks(coords.data(), values, gradients, hessians, n, std::integral_constant<bool, POWER_TABLE>());
+    }
+
+    void evaluateDerivativesBatch(const TCoeff* xs, const TCoeff* ys, const TCoeff* zs, TCoeff* values,
+        TCoeff* gradients, TCoeff* hessians, size_t n) const {
+        static_assert(VARIABLES <= 3, "Для раскладок с большим числом переменных координаты передаются массивом");
+        const TCoeff* all[3] = { xs, ys, zs };
+        std::array<const TCoeff*, VARIABLES> coords;
+        std::copy(all, all + VARIABLES, coords.begin());
+        evaluateDerivativesBatch(coords, values, gradients, hessians, n);
+    }
+
+    // Частная производная по переменной var. Вычитание place(var) из ключей
+    // мономов, содержащих var, сохраняет их порядок, поэтому результат
+    // канонический без сортировки.
+    Polynomial derivative(int var) const {
+        if (var < 0 || var >= VARIABLES) {
+            throw std::out_of_range("Номер переменной вне допустимого диапазона.");
+        }
+        Polynomial result;
+        const key_type place = static_cast<key_type>(TLayout::place(var));
+        for (const auto& term : getTerms()) {
+            const int e = term.exponent(var);
+            if (e == 0) continue;
+            TCoeff coeff = term.coeff * TCoeff(e);
+            if (!Traits::isZero(coeff)) {
+                result.terms.push_back(Monomial::fromKey(coeff, static_cast<key_type>(term.key - place)));
+            }
+        }
+        return result;
+    }
+
+    // Старшая степень по переменной var (0 - x, 1 - y, 2 - z, далее по
+    // VARIABLE_NAMES); для нулевого полинома 0
+    int degree(int var) const {
+        const TermList& sorted = getTerms();
+        if (sorted.empty()) return 0;
+        if (var == 0) return sorted.front().exponent(0);
+        int result = 0;
+        for (const auto& term : sorted) {
+            result = std::max(result, term.exponent(var));
+        }
+        return result;
+    }
+
+    DensePolynomial toDense() const {
+        static_assert(TLayout::DENSE, "Плотное представление недоступно для большого пространства ключей");
+        normalize();
+        return DensePolynomial(terms);
+    }
 };
 
-std::ostream& operator<<(std::ostream& ostr, const Polynomial& poly) {
-    if (poly.terms.empty()) {
+template<class TCoeff, class TLayout> constexpr int TPolynomial<TCoeff, TLayout>::VARIABLES;
+template<class TCoeff, class TLayout> constexpr bool TPolynomial<TCoeff, TLayout>::POWER_TABLE;
+template<class TCoeff, class TLayout> constexpr int TPolynomial<TCoeff, TLayout>::BATCH_BLOCK;
+
+using Polynomial = TPolynomial<double>;
+
+// Полином от NVars переменных (x, y, z, w, u, v, s, t) со степенями 0-MaxDeg.
+// Мономы по-прежнему упаковываются в одно машинное слово, выбранное на этапе
+// компиляции: например, PolynomialN<4, 6> хранит ключи в uint16_t, а
+// PolynomialN<6, 5> - в uint32_t.
+template<int NVars, int MaxDeg, class TCoeff = double>
+using PolynomialN = TPolynomial<TCoeff, MonomialLayout<NVars, MaxDeg>>;
+
+template<class TCoeff, class TLayout>
+std::ostream& operator<<(std::ostream& ostr, const TPolynomial<TCoeff, TLayout>& poly) {
+    using Traits = CoeffTraits<TCoeff>;
+    const auto& terms = poly.getTerms();
+    if (terms.empty()) {
         return ostr << "0";
     }
     bool first_term_printed = false;
 
-    for (const auto& term : poly.terms) {
-        if (std::abs(term.coeff) < EPSILON) continue;
+    for (const auto& term : terms) {
+        if (Traits::isZero(term.coeff)) continue;
+        bool negative = Traits::isNegative(term.coeff);
         if (first_term_printed) {
-            if (term.coeff > 0) ostr << " + ";
+            if (!negative) ostr << " + ";
             else ostr << " - "; 
         }
         else {
-            if (term.coeff < 0) ostr << "-";
+            if (negative) ostr << "-";
         }
 
-        double abs_coeff = std::fabs(term.coeff); 
-        bool has_variables = (term.px > 0 || term.py > 0 || term.pz > 0);
-        bool is_coeff_one_abs = std::fabs(abs_coeff - 1.0) < EPSILON;
+        TCoeff abs_coeff = negative ? -term.coeff : term.coeff; 
+        bool has_variables = term.key != 0;
+        bool is_coeff_one_abs = Traits::equal(abs_coeff, TCoeff(1));
 
         if (has_variables) { 
             if (!is_coeff_one_abs) {
                 std::ostringstream coeff_ss;
-                coeff_ss.precision(std::numeric_limits<double>::max_digits10);
+                coeff_ss.precision(std::numeric_limits<TCoeff>::max_digits10);
                 coeff_ss << abs_coeff;
                 ostr << coeff_ss.str();
                 ostr << "*";
@@ -210,27 +1555,18 @@ std::ostream& operator<<(std::ostream& ostr, const Polynomial& poly) {
         }
         else { 
             std::ostringstream coeff_ss;
-            coeff_ss.precision(std::numeric_limits<double>::max_digits10);
+            coeff_ss.precision(std::numeric_limits<TCoeff>::max_digits10);
             coeff_ss << abs_coeff;
             ostr << coeff_ss.str();
         }
 
         bool first_var_printed = false; 
-        if (term.px > 0) {
-            ostr << "x";
-            if (term.px > 1) ostr << "^" << term.px; 
-            first_var_printed = true;
-        }
-        if (term.py > 0) {
+        for (int var = 0; var < TLayout::VARIABLES; ++var) {
+            int power = term.exponent(var);
+            if (power == 0) continue;
             if (first_var_printed) ostr << "*"; 
-            ostr << "y";
-            if (term.py > 1) ostr << "^" << term.py;
-            first_var_printed = true;
-        }
-        if (term.pz > 0) {
-            if (first_var_printed) ostr << "*"; 
-            ostr << "z";
-            if (term.pz > 1) ostr << "^" << term.pz;
+            ostr << VARIABLE_NAMES[var];
+            if (power > 1) ostr << "^" << power;
             first_var_printed = true;
         }
         first_term_printed = true;
@@ -238,6 +1574,280 @@ std::ostream& operator<<(std::ostream& ostr, const Polynomial& poly) {
     return ostr;
 }
 
+namespace std {
+    // Хеш канонической формы: ключи мономов и хеши коэффициентов по порядку
+    // (для double и float - квантованных, см. CoeffTraits). Не зависит от
+    // адресов и запуска программы.
+    template<class TCoeff, class TLayout>
+    struct hash<TPolynomial<TCoeff, TLayout>> {
+        size_t operator()(const TPolynomial<TCoeff, TLayout>& poly) const {
+            size_t result = 0;
+            auto combine = [&result](size_t value) {
+                result ^= value + 0x9e3779b97f4a7c15ULL + (result << 6) + (result >> 2);
+            };
+            for (const auto& term : poly.getTerms()) {
+                combine(static_cast<size_t>(term.key));
+                combine(CoeffTraits<TCoeff>::hash(term.coeff));
+            }
+            return result;
+        }
+    };
+}
+
+
+// Шаблоны выражений над полиномами. Цепочка вида lazy(a) + lazy(b) * c - d не
+// вычисляется по шагам, а запоминается как дерево и при преобразовании в
+// Polynomial вычисляется за один проход: все слагаемые и произведения
+// накапливаются в одном плотном массиве, который затем один раз сжимается.
+// Для раскладок без плотного массива выражение вычисляется по узлам обычной
+// арифметикой. Операнды хранятся по ссылке, поэтому выражение нужно вычислять
+// в том же полном выражении, где оно построено.
+template<class E>
+struct PolyExpr {
+    const E& self() const {
+        return static_cast<const E&>(*this);
+    }
+
+    template<class TCoeff, class TLayout>
+    operator TPolynomial<TCoeff, TLayout>() const;
+};
+
+template<class P>
+struct PolyRef : PolyExpr<PolyRef<P>> {
+    using polynomial_type = P;
+    using coeff_type = typename P::coeff_type;
+    const P* poly;
+    explicit PolyRef(const P& p) : poly(&p) {}
+};
+
+template<class L, class R>
+struct PolySum : PolyExpr<PolySum<L, R>> {
+    using polynomial_type = typename L::polynomial_type;
+    using coeff_type = typename L::coeff_type;
+    L left;
+    R right;
+    PolySum(const L& l, const R& r) : left(l), right(r) {}
+};
 
+template<class L, class R>
+struct PolyDiff : PolyExpr<PolyDiff<L, R>> {
+    using polynomial_type = typename L::polynomial_type;
+    using coeff_type = typename L::coeff_type;
+    L left;
+    R right;
+    PolyDiff(const L& l, const R& r) : left(l), right(r) {}
+};
 
+template<class L, class R>
+struct PolyProduct : PolyExpr<PolyProduct<L, R>> {
+    using polynomial_type = typename L::polynomial_type;
+    using coeff_type = typename L::coeff_type;
+    L left;
+    R right;
+    PolyProduct(const L& l, const R& r) : left(l), right(r) {}
+};
 
+template<class E>
+struct PolyScaled : PolyExpr<PolyScaled<E>> {
+    using polynomial_type = typename E::polynomial_type;
+    using coeff_type = typename E::coeff_type;
+    E expr;
+    coeff_type constant;
+    PolyScaled(const E& e, coeff_type c) : expr(e), constant(c) {}
+};
+
+// Начало ленивого выражения
+template<class TCoeff, class TLayout>
+PolyRef<TPolynomial<TCoeff, TLayout>> lazy(const TPolynomial<TCoeff, TLayout>& p) {
+    return PolyRef<TPolynomial<TCoeff, TLayout>>(p);
+}
+
+template<class L, class R>
+PolySum<L, R> operator+(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolySum<L, R>(l.self(), r.self());
+}
+
+template<class L, class T, class TL>
+PolySum<L, PolyRef<TPolynomial<T, TL>>> operator+(const PolyExpr<L>& l, const TPolynomial<T, TL>& r) {
+    return PolySum<L, PolyRef<TPolynomial<T, TL>>>(l.self(), lazy(r));
+}
+
+template<class T, class TL, class R>
+PolySum<PolyRef<TPolynomial<T, TL>>, R> operator+(const TPolynomial<T, TL>& l, const PolyExpr<R>& r) {
+    return PolySum<PolyRef<TPolynomial<T, TL>>, R>(lazy(l), r.self());
+}
+
+template<class L, class R>
+PolyDiff<L, R> operator-(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolyDiff<L, R>(l.self(), r.self());
+}
+
+template<class L, class T, class TL>
+PolyDiff<L, PolyRef<TPolynomial<T, TL>>> operator-(const PolyExpr<L>& l, const TPolynomial<T, TL>& r) {
+    return PolyDiff<L, PolyRef<TPolynomial<T, TL>>>(l.self(), lazy(r));
+}
+
+template<class T, class TL, class R>
+PolyDiff<PolyRef<TPolynomial<T, TL>>, R> operator-(const TPolynomial<T, TL>& l, const PolyExpr<R>& r) {
+    return PolyDiff<PolyRef<TPolynomial<T, TL>>, R>(lazy(l), r.self());
+}
+
+template<class L, class R>
+PolyProduct<L, R> operator*(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolyProduct<L, R>(l.self(), r.self());
+}
+
+template<class L, class T, class TL>
+PolyProduct<L, PolyRef<TPolynomial<T, TL>>> operator*(const PolyExpr<L>& l, const TPolynomial<T, TL>& r) {
+    return PolyProduct<L, PolyRef<TPolynomial<T, TL>>>(l.self(), lazy(r));
+}
+
+template<class T, class TL, class R>
+PolyProduct<PolyRef<TPolynomial<T, TL>>, R> operator*(const TPolynomial<T, TL>& l, const PolyExpr<R>& r) {
+    return PolyProduct<PolyRef<TPolynomial<T, TL>>, R>(lazy(l), r.self());
+}
+
+template<class E>
+PolyScaled<E> operator*(const PolyExpr<E>& e, typename E::coeff_type constant) {
+    return PolyScaled<E>(e.self(), constant);
+}
+
+// Диапазон ключей, затронутых при накоплении
+struct KeyRange {
+    int low = std::numeric_limits<int>::max();
+    int high = -1;
+
+    void include(int low_key, int high_key) {
+        low = std::min(low, low_key);
+        high = std::max(high, high_key);
+    }
+};
+
+template<class E>
+typename E::polynomial_type evaluate(const PolyExpr<E>& expr);
+
+// Сомножители произведения: исходный полином берется по ссылке,
+// вложенное выражение вычисляется отдельно
+template<class P>
+const P& materialize(const PolyRef<P>& ref) {
+    return *ref.poly;
+}
+
+template<class E>
+typename E::polynomial_type materialize(const PolyExpr<E>& expr) {
+    return evaluate(expr);
+}
+
+template<class P>
+void accumulate(const PolyRef<P>& ref, typename P::coeff_type sign, typename P::DensePolynomial& acc, KeyRange& range) {
+    const auto& terms = ref.poly->getTerms();
+    if (terms.empty()) return;
+    acc.add(terms, sign);
+    range.include(terms.back().key, terms.front().key);
+}
+
+template<class L, class R, class T, class D>
+void accumulate(const PolySum<L, R>& node, T sign, D& acc, KeyRange& range) {
+    accumulate(node.left, sign, acc, range);
+    accumulate(node.right, sign, acc, range);
+}
+
+template<class L, class R, class T, class D>
+void accumulate(const PolyDiff<L, R>& node, T sign, D& acc, KeyRange& range) {
+    accumulate(node.left, sign, acc, range);
+    accumulate(node.right, -sign, acc, range);
+}
+
+template<class E, class T, class D>
+void accumulate(const PolyScaled<E>& node, T sign, D& acc, KeyRange& range) {
+    accumulate(node.expr, sign * node.constant, acc, range);
+}
+
+// Произведение накапливается прямо в общий массив, без промежуточного полинома
+template<class L, class R, class T, class D>
+void accumulate(const PolyProduct<L, R>& node, T sign, D& acc, KeyRange& range) {
+    using Layout = typename PolyProduct<L, R>::polynomial_type::Layout;
+    const auto& a = materialize(node.left);
+    const auto& b = materialize(node.right);
+    const auto& a_terms = a.getTerms();
+    const auto& b_terms = b.getTerms();
+    if (a_terms.empty() || b_terms.empty()) return;
+    for (int var = 0; var < Layout::VARIABLES; ++var) {
+        if (a.degree(var) + b.degree(var) > Layout::MAX_DEGREE) {
+            throw std::out_of_range("Ошибка умножения полиномов: Умножение мономов приводит к степеням вне допустимого диапазона (0-" + std::to_string(Layout::MAX_DEGREE) + ").");
+        }
+    }
+    for (const auto& term1 : a_terms) {
+        T coeff = sign * term1.coeff;
+        for (const auto& term2 : b_terms) {
+            acc[term1.key + term2.key] += coeff * term2.coeff;
+        }
+    }
+    range.include(a_terms.back().key + b_terms.back().key, a_terms.front().key + b_terms.front().key);
+}
+
+// Вычисление по узлам для раскладок без плотного массива
+template<class P>
+P evaluateSparse(const PolyRef<P>& ref) {
+    return *ref.poly;
+}
+
+template<class L, class R>
+typename L::polynomial_type evaluateSparse(const PolySum<L, R>& node) {
+    return evaluateSparse(node.left) + evaluateSparse(node.right);
+}
+
+template<class L, class R>
+typename L::polynomial_type evaluateSparse(const PolyDiff<L, R>& node) {
+    return evaluateSparse(node.left) - evaluateSparse(node.right);
+}
+
+template<class E>
+typename E::polynomial_type evaluateSparse(const PolyScaled<E>& node) {
+    return evaluateSparse(node.expr) * node.constant;
+}
+
+template<class L, class R>
+typename L::polynomial_type evaluateSparse(const PolyProduct<L, R>& node) {
+    return materialize(node.left) * materialize(node.right);
+}
+
+// Накопление идет в плотном массиве потока (вложенное выражение получит свой),
+// а сжатие массива сразу дает канонический список
+template<class E>
+typename E::polynomial_type evaluateExpr(const PolyExpr<E>& expr, std::true_type /*dense*/) {
+    using P = typename E::polynomial_type;
+    using T = typename E::coeff_type;
+    typename P::DenseScratch lease;
+    typename P::DensePolynomial& acc = *lease;
+    KeyRange range;
+    try {
+        accumulate(expr.self(), T(1), acc, range);
+    }
+    catch (...) {
+        // Массив потока должен остаться обнуленным
+        if (range.low <= range.high) acc.extractTerms(range.low, range.high);
+        throw;
+    }
+    if (range.high < range.low) {
+        return P();
+    }
+    return P::fromCanonical(acc.extractTerms(range.low, range.high));
+}
+
+template<class E>
+typename E::polynomial_type evaluateExpr(const PolyExpr<E>& expr, std::false_type /*dense*/) {
+    return evaluateSparse(expr.self());
+}
+
+template<class E>
+typename E::polynomial_type evaluate(const PolyExpr<E>& expr) {
+    using Layout = typename E::polynomial_type::Layout;
+    return evaluateExpr(expr, std::integral_constant<bool, Layout::DENSE>());
+}
+
+template<class E>
+template<class TCoeff, class TLayout>
+PolyExpr<E>::operator TPolynomial<TCoeff, TLayout>() const {
+    return evaluate(*this);
+}
@@ -14,11 +14,19 @@
 #include "polynomial.h"
 #include "Parser.h"
 
-class PolynomialTranslyator {
+// Транслятор выражений над полиномами с коэффициентами типа TCoeff: операнды
+// разбираются parsePolynomial<TCoeff>, поэтому хранилище, настроенное на
+// int64_t, ModInt или float, получает результаты своего типа. TLayout задает
+// переменные и наибольшую степень (см. MonomialLayout).
+template<class TCoeff = double, class TLayout = DefaultLayout>
+class TPolynomialTranslyator {
+public:
+    using Polynomial = TPolynomial<TCoeff, TLayout>;
+
 private:
     std::vector<std::string> data; // Токены: либо строки операторов, либо строковое представление полинома
 
-    const std::string operators = "+-*/()";
+    const std::string operators = "+-*/()^";
 
     // Вспомогательная функция для проверки, является ли токен одним из определенных операторов или скобок
     bool isOperator(const std::string& str) const {
@@ -36,6 +44,11 @@ private:
     }
 
 
+    // Вспомогательная функция для проверки, является ли токен показателем степени (целое неотрицательное число после '^')
+    bool isExponentToken(const std::string& str) const {
+        return !str.empty() && std::all_of(str.begin(), str.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+    }
+
     // Вспомогательная функция для проверки, является ли токен строковым представлением полинома
     // Это любой токен, который не является распознанным оператором/скобкой
     bool isPolynomialToken(const std::string& str) const {
@@ -62,6 +75,14 @@ private:
                 continue;
             }
 
+            // '^' - оператор степени только сразу после закрывающей скобки: (x+y)^3.
+            // Внутри полинома (x^2) он остается частью токена.
+            if (c == '^' && !(currentToken.empty() && !data.empty() && data.back() == ")")) {
+                currentToken += c;
+                lastNonSpaceCharWasOperatorOrOpenParen = false;
+                continue;
+            }
+
             if (isOperator(std::string(1, c))) {
                 // Это оператор или скобка
                 if (!currentToken.empty()) {
@@ -105,7 +126,7 @@ private:
             throw std::runtime_error("Неверное выражение: Начинается с недопустимого токена '" + data.front() + "'.");
         }
         // Выражение не может заканчиваться бинарным оператором (*, /) или открывающей скобкой
-        if (isBinaryOperator(data.back()) || data.back() == "(") {
+        if (isBinaryOperator(data.back()) || data.back() == "(" || data.back() == "^") {
             throw std::runtime_error("Неверное выражение: Заканчивается недопустимым токеном '" + data.back() + "'.");
         }
 
@@ -151,6 +172,11 @@ private:
             }
 
 
+            // За оператором степени должен следовать целый неотрицательный показатель
+            if (current == "^" && !isExponentToken(next)) {
+                throw std::runtime_error("Неверное выражение: После '^' ожидается целый неотрицательный показатель степени.");
+            }
+
             // Последовательные бинарные операторы (например, +* , /- )
             if (isBinaryOperator(current) && isBinaryOperator(next)) {
                 // Специально для операторов + и -: ++, +-, --, -+ разрешены, если рассматриваются как унарные знаки в составе полинома.
@@ -185,7 +211,7 @@ private:
 
 public:
     // Конструктор принимает строку и парсит/валидирует её
-    explicit PolynomialTranslyator(const std::string& str) {
+    explicit TPolynomialTranslyator(const std::string& str) {
         std::string trimmed_str = str; // std::string str = trim(input_str); // Если нужна функция trim
 
         // Проверка на пустую строку или строку только из пробелов перед токенизацией
@@ -204,7 +230,7 @@ public:
     }
 
     // Конструктор по умолчанию для создания пустого транслятора
-    PolynomialTranslyator() = default;
+    TPolynomialTranslyator() = default;
 
 
     // Вычисляет значение выражения - возвращает Полином
@@ -222,16 +248,17 @@ public:
             if (operands.size() < 2) {
                 throw std::runtime_error("Ошибка вычисления: Недостаточно операндов для оператора.");
             }
-            Polynomial operand2 = operands.top(); operands.pop(); // Второй операнд (сверху стека)
-            Polynomial operand1 = operands.top(); operands.pop(); // Первый операнд
+            // Операнды перемещаются из стека, а не копируются
+            Polynomial operand2 = std::move(operands.top()); operands.pop(); // Второй операнд (сверху стека)
+            Polynomial operand1 = std::move(operands.top()); operands.pop(); // Первый операнд
             if (operators.empty()) {
                 throw std::runtime_error("Ошибка вычисления: Стек операторов пуст при попытке выполнения операции.");
             }
             std::string op = operators.top(); operators.pop(); // Оператор
 
             // Выполнение операции над Полиномами
-            if (op == "+") operands.push(operand1 + operand2);
-            else if (op == "-") operands.push(operand1 - operand2);
+            if (op == "+") operands.push(std::move(operand1) + operand2);
+            else if (op == "-") operands.push(std::move(operand1) - operand2);
             else if (op == "*") operands.push(operand1 * operand2);
             else if (op == "/") {
                 // Деление полиномов не поддерживается
@@ -243,12 +270,29 @@ public:
             }
             };
 
+        bool expectExponent = false; // Предыдущий токен - '^', текущий - показатель степени
+
         // Алгоритм Shunting-Yard для вычисления инфиксного выражения
         for (const std::string& i : data) {
-            if (isPolynomialToken(i)) { // Если токен - строковое представление полинома
+            if (expectExponent) {
+                // Степень связывает сильнее любого бинарного оператора, поэтому применяется
+                // сразу к только что вычисленному содержимому скобок на вершине стека
+                if (i.length() > 9) {
+                    throw std::out_of_range("Ошибка вычисления: Слишком большой показатель степени '" + i + "'.");
+                }
+                operands.top() = operands.top().pow(std::stoi(i));
+                expectExponent = false;
+            }
+            else if (i == "^") {
+                if (operands.empty()) {
+                    throw std::runtime_error("Ошибка вычисления: Нет операнда для оператора '^'.");
+                }
+                expectExponent = true;
+            }
+            else if (isPolynomialToken(i)) { // Если токен - строковое представление полинома
                 try {
                     // Парсим строку в объект Polynomial и помещаем в стек операндов
-                    operands.push(parsePolynomial(i));
+                    operands.push(parsePolynomial<TCoeff, TLayout>(i));
                 }
                 catch (const std::runtime_error& e) {
                     // Перехватываем ошибки парсинга полинома и перебрасываем с контекстом
@@ -308,11 +352,11 @@ public:
             throw std::runtime_error("Ошибка вычисления: Неверный формат выражения, приведший к некорректному состоянию стеков в конце.");
         }
 
-        return operands.top(); // Возвращаем финальный результат (Полином)
+        return std::move(operands.top()); // Возвращаем финальный результат (Полином)
     }
 
     // Перегрузка оператора << для вывода токенизированного выражения
-    friend std::ostream& operator<<(std::ostream& ostr, const PolynomialTranslyator& other) {
+    friend std::ostream& operator<<(std::ostream& ostr, const TPolynomialTranslyator& other) {
         if (other.data.empty()) {
             ostr << "[Выражение пустое/невалидное]";
         }
@@ -342,4 +386,4 @@ public:
     }
 };
 
-
+using PolynomialTranslyator = TPolynomialTranslyator<double>;
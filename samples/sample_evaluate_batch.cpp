@@ -0,0 +1,75 @@
+#include <iostream>
+#include <clocale>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include "polynomial.h"
+
+// Замер пакетного вычисления значений полинома: число точек в секунду для
+// вычисления по одной точке (evaluate) и пакетами (evaluateBatch).
+// Векторное ядро выбирается во время выполнения по возможностям процессора
+// (для MSVC - по флагам сборки /arch:AVX2, /arch:AVX512).
+// Аргументы: число точек (по умолчанию 1 000 000) и число повторов (5), оба
+// не меньше 1.
+
+template<class F>
+double measureSeconds(int repeats, F f) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    std::setlocale(LC_ALL, "");
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (n < 1 || repeats < 1) {
+        std::cerr << "Ошибка: Число точек и число повторов должны быть положительными." << std::endl;
+        return 1;
+    }
+
+    const char* kernel_names[] = { "скалярное", "AVX2", "AVX-512" };
+    std::cout << "Векторное ядро: " << kernel_names[static_cast<int>(bestBatchKernel())] << std::endl;
+
+    std::vector<double> xs(n), ys(n), zs(n), out(n);
+    for (size_t j = 0; j < n; ++j) {
+        xs[j] = -1.0 + 2.0 * (j % 1000) / 1000;
+        ys[j] = -1.0 + 2.0 * (j % 997) / 997;
+        zs[j] = -1.0 + 2.0 * (j % 991) / 991;
+    }
+
+    // Полиномы с 10, 100 и 1000 мономами
+    for (int step : { 100, 10, 1 }) {
+        TermList terms;
+        for (int key = 0; key < MONOMIAL_KEY_COUNT; key += step) {
+            terms.push_back(Monomial::fromKey(1.0 + key % 7, key));
+        }
+        Polynomial p(terms);
+
+        double checksum = 0;
+        double pointwise = measureSeconds(repeats, [&]() {
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = p.evaluate(xs[j], ys[j], zs[j]);
+            }
+        });
+        checksum += out[n / 2];
+        double batch = measureSeconds(repeats, [&]() {
+            p.evaluateBatch(xs.data(), ys.data(), zs.data(), out.data(), n);
+        });
+        checksum += out[n / 2];
+
+        std::cout << "Мономов: " << p.getTerms().size() << std::endl;
+        std::cout << "  evaluate:      " << n / pointwise << " точек/с" << std::endl;
+        std::cout << "  evaluateBatch: " << n / batch << " точек/с (x" << pointwise / batch << ")" << std::endl;
+        std::cout << "  контрольная сумма: " << checksum << std::endl;
+    }
+    return 0;
+}
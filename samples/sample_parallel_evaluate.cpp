@@ -0,0 +1,83 @@
+#include <iostream>
+#include <clocale>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+
+#include "polynomial.h"
+#include "EvaluationEngine.h"
+
+// Масштабируемость параллельного вычисления значений полинома: для 1, 2, 4, ...
+// потоков (до числа аппаратных потоков или второго аргумента) выводятся число
+// точек в секунду, ускорение относительно одного потока и эффективность.
+// Аргументы: число точек (по умолчанию 16 000 000), наибольшее число потоков
+// (не меньше 1).
+
+int main(int argc, char* argv[])
+{
+    std::setlocale(LC_ALL, "");
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16000000;
+    int max_arg = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (n < 1 || max_arg < 1) {
+        std::cerr << "Ошибка: Число точек и число потоков должны быть положительными." << std::endl;
+        return 1;
+    }
+    unsigned max_threads = static_cast<unsigned>(max_arg);
+
+    TermList terms;
+    for (int key = 0; key < MONOMIAL_KEY_COUNT; key += 5) {
+        terms.push_back(Monomial::fromKey(1.0 + key % 7, key));
+    }
+    Polynomial p(terms);
+
+    std::vector<double> xs(n), ys(n), zs(n), out(n);
+    for (size_t j = 0; j < n; ++j) {
+        xs[j] = -1.0 + 2.0 * (j % 1000) / 1000;
+        ys[j] = -1.0 + 2.0 * (j % 997) / 997;
+        zs[j] = -1.0 + 2.0 * (j % 991) / 991;
+    }
+
+    std::cout << "Мономов: " << p.getTerms().size() << ", точек: " << n << std::endl;
+    std::cout << "Потоков\tТочек/с\t\tУскорение\tЭффективность" << std::endl;
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double base_rate = 0;
+    for (unsigned threads : thread_counts) {
+        // Вызывающий поток тоже вычисляет части, поэтому в пуле threads - 1
+        // потоков; один поток считает без пула (ThreadPool(0) - это все ядра)
+        std::unique_ptr<ThreadPool> pool;
+        std::unique_ptr<EvaluationEngine> engine;
+        if (threads > 1) {
+            pool.reset(new ThreadPool(threads - 1));
+            engine.reset(new EvaluationEngine(*pool));
+        }
+        auto run = [&]() {
+            if (engine) {
+                engine->evaluate(p, xs.data(), ys.data(), zs.data(), out.data(), n);
+            }
+            else {
+                p.evaluateBatch(xs.data(), ys.data(), zs.data(), out.data(), n);
+            }
+        };
+        run(); // прогрев
+
+        double best = 1e300;
+        for (int r = 0; r < 3; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        double rate = n / best;
+        if (threads == 1) base_rate = rate;
+        std::cout << threads << "\t" << rate << "\t" << rate / base_rate << "\t\t" << rate / base_rate / threads << std::endl;
+    }
+    std::cout << "Контрольное значение: " << out[n / 2] << std::endl;
+    return 0;
+}
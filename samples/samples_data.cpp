@@ -90,7 +90,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
@@ -175,7 +175,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
@@ -260,7 +260,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
@@ -345,7 +345,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
@@ -430,7 +430,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
@@ -515,7 +515,7 @@ void main()
                 try {
                     PolynomialTranslyator translator(poly_string);
                     Polynomial poly_obj = translator.calculate();
-                    table.insert(k, poly_obj);
+                    table.insert(k, std::move(poly_obj));
 
                     std::cout << "Полином успешно добавлен/обновлен по ключу '" << k << "'." << std::endl;
                 }
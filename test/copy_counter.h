@@ -0,0 +1,17 @@
+﻿#pragma once
+
+// Значение, которое считает свои копирования: общий помощник тестов
+// перемещения в хранилищах
+struct CopyCounter {
+    static int& copies() {
+        static int count = 0;
+        return count;
+    }
+
+    int value;
+    CopyCounter(int v = 0) : value(v) {}
+    CopyCounter(const CopyCounter& other) : value(other.value) { copies()++; }
+    CopyCounter(CopyCounter&& other) noexcept : value(other.value) {}
+    CopyCounter& operator=(const CopyCounter& other) { value = other.value; copies()++; return *this; }
+    CopyCounter& operator=(CopyCounter&& other) noexcept { value = other.value; return *this; }
+};
@@ -1,5 +1,6 @@
 #include "gtest.h" // Google Test framework
 #include "TAVLTree.h"    // Your TAVLTree class header
+#include "copy_counter.h"
 
 TEST(AVLTreeTest, EmptyTree) {
     TAVLTree<int, std::string> tree;
@@ -329,4 +330,24 @@ TEST(AVLTreeTest, IterationDecrementEndThrows) {
     tree.insert(2, 2);
     EXPECT_THROW(tree.end()--, std::runtime_error);
     EXPECT_THROW(--tree.end(), std::runtime_error);
-}
\ No newline at end of file
+}
+
+TEST(AVLTreeTest, InsertRvalueDoesNotCopyValue) {
+    TAVLTree<int, CopyCounter> tree;
+    CopyCounter::copies() = 0;
+    for (int key = 0; key < 20; ++key) {
+        tree.insert(key, CopyCounter(key));
+    }
+    tree.insert(3, CopyCounter(33));
+    EXPECT_EQ(0, CopyCounter::copies());
+    EXPECT_EQ(20u, tree.size());
+
+    TAVLTree<int, CopyCounter> moved(std::move(tree));
+    EXPECT_EQ(20u, moved.size());
+    EXPECT_TRUE(tree.empty());
+    EXPECT_NE(moved.find(19), moved.end());
+
+    CopyCounter::copies() = 0;
+    moved.emplace(100, 100);
+    EXPECT_EQ(0, CopyCounter::copies());
+}
@@ -0,0 +1,39 @@
+#include "gtest.h"
+#include "BatchKernels.h"
+#include <vector>
+
+// Строки степеней для vars переменных и n точек
+static std::vector<std::vector<double>> makeRows(int vars, size_t n) {
+    std::vector<std::vector<double>> rows(vars, std::vector<double>(n));
+    for (int k = 0; k < vars; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            rows[k][j] = 0.75 + 0.01 * k - 0.003 * j;
+        }
+    }
+    return rows;
+}
+
+TEST(BatchKernelTests, ScalarKernelIsAlwaysSupported) {
+    EXPECT_TRUE(isBatchKernelSupported(BatchKernel::Scalar));
+    EXPECT_TRUE(isBatchKernelSupported(bestBatchKernel()));
+}
+
+TEST(BatchKernelTests, EverySupportedKernelMatchesScalarLoop) {
+    for (BatchKernel kernel : { BatchKernel::Scalar, BatchKernel::Avx2, BatchKernel::Avx512 }) {
+        if (!isBatchKernelSupported(kernel)) continue;
+        for (int vars = 1; vars <= 4; ++vars) {
+            // Длины с остатками для всех ширин векторов
+            for (size_t n : { 0, 1, 3, 4, 7, 8, 13, 64 }) {
+                std::vector<std::vector<double>> rows = makeRows(vars, n);
+                std::vector<const double*> ptrs;
+                for (const auto& row : rows) ptrs.push_back(row.data());
+                std::vector<double> out(n, 1.5), expected(n, 1.5);
+                accumulateTerm(kernel, -2.5, ptrs.data(), vars, out.data(), n);
+                accumulateTerm<double>(-2.5, ptrs.data(), vars, expected.data(), n);
+                for (size_t j = 0; j < n; ++j) {
+                    EXPECT_NEAR(out[j], expected[j], 1e-14) << "kernel " << static_cast<int>(kernel) << ", vars " << vars << ", n " << n;
+                }
+            }
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "ChainHashTable.h" 
+#include "copy_counter.h"
 
 #include <gtest.h>  
 #include <string>        
@@ -125,3 +126,22 @@ TEST(ChainHashTable, someTestsForStringKey) {
 	}
 
 }
+
+TEST(ChainHashTable, insertOfRvalueDoesNotCopyValue) {
+	ChainHashTable<int, CopyCounter> map;
+	CopyCounter::copies() = 0;
+	for (int i = 0; i < 20; i++) {
+		map.insert(i, CopyCounter(i));
+	}
+	EXPECT_EQ(0, CopyCounter::copies());
+	EXPECT_EQ(7, (*map.find(7)).second.value);
+
+	ChainHashTable<int, CopyCounter> moved(std::move(map));
+	EXPECT_EQ(20, moved.size());
+	EXPECT_TRUE(map.empty());
+	ASSERT_NO_THROW(map.insert(1, CopyCounter(1)));
+
+	CopyCounter::copies() = 0;
+	moved.emplace(100, 100);
+	EXPECT_EQ(0, CopyCounter::copies());
+}
@@ -0,0 +1,59 @@
+#include "gtest.h"
+#include "EvaluationEngine.h"
+#include "Parser.h"
+#include <vector>
+
+TEST(EvaluationEngineTests, ChunksFitCacheLines) {
+    ThreadPool pool(2);
+    EvaluationEngine engine(pool);
+    size_t points = engine.chunkPoints<double, 3>();
+    EXPECT_EQ(points % (CACHE_LINE_SIZE / sizeof(double)), 0u);
+    EXPECT_LE(points * 4 * sizeof(double), EVALUATION_CHUNK_BYTES);
+    EvaluationEngine tiny(pool, 1);
+    size_t tiny_points = tiny.chunkPoints<double, 3>();
+    EXPECT_EQ(tiny_points, CACHE_LINE_SIZE / sizeof(double));
+}
+
+TEST(EvaluationEngineTests, MatchesBatchEvaluation) {
+    Polynomial p = parsePolynomial("3x^9*y^2 - x^4*z^7 + 0.5x^4*y + 2x*y^3*z - y^9 + 7z - 4");
+    const size_t n = 10007;
+    std::vector<double> xs(n), ys(n), zs(n), expected(n), out(n + 1);
+    for (size_t j = 0; j < n; ++j) {
+        xs[j] = -1.0 + 2.0 * j / n;
+        ys[j] = 0.5 - 1.0 * j / n;
+        zs[j] = 0.25 + 0.5 * j / n;
+    }
+    p.evaluateBatch(xs.data(), ys.data(), zs.data(), expected.data(), n);
+
+    ThreadPool pool(4);
+    // Маленькие части и невыровненный результат: граничные случаи разбиения
+    EvaluationEngine engine(pool, 4096);
+    engine.evaluate(p, xs.data(), ys.data(), zs.data(), out.data() + 1, n);
+    for (size_t j = 0; j < n; ++j) {
+        EXPECT_EQ(out[j + 1], expected[j]);
+    }
+
+    EvaluationEngine(pool).evaluate(p, xs.data(), ys.data(), zs.data(), out.data(), n);
+    for (size_t j = 0; j < n; ++j) {
+        EXPECT_EQ(out[j], expected[j]);
+    }
+}
+
+TEST(EvaluationEngineTests, WorksForAnyLayout) {
+    using Poly6 = PolynomialN<6, 12>;
+    Poly6 p = parsePolynomial<double, Poly6::Layout>("x^12*v - 2y*w^3*u + z^5 + u^2*v^11 - 1");
+    const size_t n = 3000;
+    std::vector<std::vector<double>> coords(6, std::vector<double>(n));
+    std::array<const double*, 6> ptrs;
+    for (int var = 0; var < 6; ++var) {
+        for (size_t j = 0; j < n; ++j) {
+            coords[var][j] = 0.9 + 0.01 * var - 0.0001 * j;
+        }
+        ptrs[var] = coords[var].data();
+    }
+    std::vector<double> expected(n), out(n);
+    p.evaluateBatch(ptrs, expected.data(), n);
+    ThreadPool pool(3);
+    EvaluationEngine(pool, 2048).evaluate(p, ptrs, out.data(), n);
+    EXPECT_EQ(out, expected);
+}
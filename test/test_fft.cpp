@@ -0,0 +1,50 @@
+#include "gtest.h"
+#include "FFT.h"
+#include <vector>
+#include <complex>
+
+static std::vector<double> convolveNaive(const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> result(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    return result;
+}
+
+TEST(FftTests, LengthIsNextPowerOfTwo) {
+    EXPECT_EQ(fftLength(0), 1u);
+    EXPECT_EQ(fftLength(1), 1u);
+    EXPECT_EQ(fftLength(5), 8u);
+    EXPECT_EQ(fftLength(1024), 1024u);
+}
+
+TEST(FftTests, InverseRestoresInput) {
+    std::vector<std::complex<double>> data(16);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = std::complex<double>(static_cast<double>(i % 5) - 2.0, 0.5 * i);
+    }
+    std::vector<std::complex<double>> original = data;
+    fft(data, false);
+    fft(data, true);
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_NEAR(data[i].real(), original[i].real(), 1e-12);
+        EXPECT_NEAR(data[i].imag(), original[i].imag(), 1e-12);
+    }
+}
+
+TEST(FftTests, ConvolutionMatchesSchoolbook) {
+    std::vector<double> a, b;
+    for (int i = 0; i < 37; ++i) a.push_back((i * 7) % 11 - 5.0);
+    for (int i = 0; i < 100; ++i) b.push_back(0.25 * ((i * 3) % 8) - 1.0);
+    std::vector<double> expected = convolveNaive(a, b);
+    std::vector<double> result = convolve(a, b);
+    ASSERT_EQ(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        EXPECT_NEAR(result[i], expected[i], 1e-9);
+    }
+    EXPECT_TRUE(convolve(a, std::vector<double>()).empty());
+    EXPECT_EQ(convolve(std::vector<double>{ 3.0 }, std::vector<double>{ -2.0 }).size(), 1u);
+    EXPECT_NEAR(convolve(std::vector<double>{ 3.0 }, std::vector<double>{ -2.0 })[0], -6.0, 1e-12);
+}
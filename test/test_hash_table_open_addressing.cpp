@@ -3,6 +3,7 @@
 #include <vector>
 #include <set> // Для проверки уникальности ключей и сравнения содержимого
 #include "../include/HashTableOpenAddressing.h"
+#include "copy_counter.h"
 #include <map>
 
 // --- Тесты для HashTableOpenAddressing ---
@@ -473,4 +474,27 @@ TEST(HashTableOpenAddressingAdvTest, DereferenceEndIteratorThrows) {
     HashTableOpenAddressing<int, int> empty_ht;
     auto it_empty_end = empty_ht.end();
     EXPECT_THROW((*it_empty_end), std::out_of_range);
-}
\ No newline at end of file
+}
+
+TEST(HashTableOpenAddressingTest, InsertRvalueDoesNotCopyValue) {
+    HashTableOpenAddressing<int, CopyCounter> ht;
+    CopyCounter::copies() = 0;
+    for (int key = 0; key < 40; ++key) { // С несколькими перехешированиями
+        ht.insert(key, CopyCounter(key));
+    }
+    ht.insert(3, CopyCounter(33));
+    EXPECT_EQ(0, CopyCounter::copies());
+    EXPECT_EQ(40u, ht.size());
+    EXPECT_EQ(33, ht.find(3)->value);
+
+    HashTableOpenAddressing<int, CopyCounter> moved(std::move(ht));
+    EXPECT_EQ(40u, moved.size());
+    EXPECT_TRUE(ht.empty());
+    EXPECT_EQ(nullptr, ht.find(3));
+    ht.insert(1, CopyCounter(1));
+    EXPECT_EQ(1, ht.find(1)->value);
+
+    CopyCounter::copies() = 0;
+    ht.emplace(100, 100);
+    EXPECT_EQ(0, CopyCounter::copies());
+}
@@ -1,5 +1,6 @@
 #include "gtest.h" 
 #include "TOrderedTable.h" 
+#include "copy_counter.h"
 #include <string>      
 #include <vector>      
 #include <stdexcept>
@@ -262,14 +263,23 @@ TEST(OrderedTableTest, IteratorComparison) {
     EXPECT_FALSE(it_end != table.end());
 }
 
-
-
-
-
-
-
-
-
-
-
-
+TEST(OrderedTableTest, InsertRvalueDoesNotCopyValue) {
+    TOrderedTable<int, CopyCounter> table;
+    CopyCounter::copies() = 0;
+    for (int key : { 5, 1, 3, 2, 4 }) {
+        table.insert(key, CopyCounter(key * 10));
+    }
+    table.insert(3, CopyCounter(33)); //   
+    EXPECT_EQ(0, CopyCounter::copies());
+    EXPECT_EQ(5u, table.size());
+    EXPECT_EQ(33, table[3].value);
+    EXPECT_EQ(1, table.begin().key());
+
+    CopyCounter lvalue(7);
+    table.insert(7, lvalue);
+    EXPECT_EQ(1, CopyCounter::copies());
+
+    CopyCounter::copies() = 0;
+    table.emplace(100, 100);
+    EXPECT_EQ(0, CopyCounter::copies());
+}
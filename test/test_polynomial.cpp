@@ -1,5 +1,6 @@
 #include "polynomial.h"
 #include "Parser.h"
+#include "transl.h"
 #include <cmath> 
 #include <sstream> 
 #include <limits> 
@@ -332,12 +333,795 @@ TEST(PolynomialTests, PolynomialMultiplicationDegreeOverflow) {
     ASSERT_THROW(p5 * p5, std::out_of_range);
 }
 
+TEST(MonomialTests, PackedKeyLayout) {
+    //        16 
+    EXPECT_LE(sizeof(Monomial), 16u);
 
+    Monomial m(2.5, 3, 7, 1);
+    EXPECT_EQ(371, m.key);
+    EXPECT_EQ(3, m.px());
+    EXPECT_EQ(7, m.py());
+    EXPECT_EQ(1, m.pz());
 
+    Monomial from_key = Monomial::fromKey(2.5, 371);
+    EXPECT_TRUE(m == from_key);
+    EXPECT_EQ(std::hash<Monomial>()(m), std::hash<Monomial>()(from_key));
+}
+
+TEST(MonomialTests, PackedKeyMultiplication) {
+    // (x^2*y^3*z) * (x^7*y^6*z^8) = x^9*y^9*z^9
+    Monomial res = Monomial(2.0, 2, 3, 1) * Monomial(3.0, 7, 6, 8);
+    EXPECT_TRUE((Monomial(6.0, 9, 9, 9) == res));
+    EXPECT_EQ(MONOMIAL_KEY_COUNT - 1, res.key);
+
+    //      ""  
+    ASSERT_THROW(Monomial(1.0, 0, 0, 9) * Monomial(1.0, 0, 0, 1), std::out_of_range);
+    ASSERT_THROW(Monomial(1.0, 0, 5, 0) * Monomial(1.0, 0, 5, 0), std::out_of_range);
+}
+
+//      first, first + step, ... (count )
+static Polynomial makeKeyPolynomial(int first, int step, int count, double coeff) {
+    std::vector<Monomial> terms;
+    for (int i = 0; i < count; ++i) {
+        int key = (first + i * step) % MONOMIAL_KEY_COUNT;
+        terms.push_back(Monomial::fromKey(coeff + i, key));
+    }
+    return Polynomial(terms);
+}
+
+TEST(DensePolynomialTests, ArithmeticMatchesSparse) {
+    std::vector<Monomial> a_terms = { {1.0, 2, 0, 0}, {3.0, 0, 1, 0}, {-2.0, 0, 0, 0} };
+    std::vector<Monomial> b_terms = { {4.0, 2, 0, 0}, {-3.0, 0, 1, 0}, {5.0, 1, 1, 1} };
+    DensePolynomial a(a_terms), b(b_terms);
+
+    EXPECT_EQ(Polynomial(a_terms) + Polynomial(b_terms), Polynomial(a + b));
+    EXPECT_EQ(Polynomial(a_terms) - Polynomial(b_terms), Polynomial(a - b));
+    EXPECT_EQ(Polynomial(a_terms) * 2.5, Polynomial(a * 2.5));
+    EXPECT_DOUBLE_EQ(5.0, (a + b)[200]);
+    EXPECT_DOUBLE_EQ(0.0, (a + b)[10]);
+}
+
+TEST(PolynomialTests, LargePolynomialsAddByMerge) {
+    // 300 + 300  -    ,  
+    // -     ( 
+    //     , . PolynomialReduction.h)
+    Polynomial p1 = makeKeyPolynomial(0, 3, 300, 1.0);
+    Polynomial p2 = makeKeyPolynomial(1, 3, 300, 2.0);
+    ASSERT_EQ(300u, p1.getTerms().size());
+
+    Polynomial sum = p1 + p2;
+    EXPECT_EQ(600u, sum.getTerms().size());
+    EXPECT_TRUE(std::is_sorted(sum.getTerms().begin(), sum.getTerms().end()));
+    EXPECT_EQ(p1, sum - p2);
+    EXPECT_EQ(0u, (p1 - p1).getTerms().size());
+    EXPECT_EQ(p1.toDense()[3] + p2.toDense()[3], sum.toDense()[3]);
+}
+
+TEST(PolynomialTests, MergeAdditionKeepsCanonicalForm) {
+    // (x^2 + 2xy - z + 4) + (-2xy + y + z) = x^2 + y + 4
+    std::vector<Monomial> p1_terms = { {1.0, 2, 0, 0}, {2.0, 1, 1, 0}, {-1.0, 0, 0, 1}, {4.0, 0, 0, 0} };
+    std::vector<Monomial> p2_terms = { {-2.0, 1, 1, 0}, {1.0, 0, 1, 0}, {1.0, 0, 0, 1} };
+    Polynomial p1(p1_terms), p2(p2_terms);
+
+    Polynomial sum = p1 + p2;
+    std::vector<Monomial> expected_sum = { {1.0, 2, 0, 0}, {1.0, 0, 1, 0}, {4.0, 0, 0, 0} };
+    ASSERT_EQ(Polynomial(expected_sum), sum);
+    EXPECT_TRUE(std::is_sorted(sum.getTerms().begin(), sum.getTerms().end()));
+
+    //      
+    Polynomial diff = p2 - p1;
+    std::vector<Monomial> expected_diff = { {-1.0, 2, 0, 0}, {-4.0, 1, 1, 0}, {1.0, 0, 1, 0}, {2.0, 0, 0, 1}, {-4.0, 0, 0, 0} };
+    ASSERT_EQ(Polynomial(expected_diff), diff);
+
+    ASSERT_EQ(p1, p1 + Polynomial());
+    ASSERT_EQ(p1 * -1.0, Polynomial() - p1);
+}
+
+TEST(PolynomialTests, HeapMultiplicationMatchesExpansion) {
+    // (x + y + z + 1)^2 -   10    
+    std::vector<Monomial> s_terms = { {1.0, 1, 0, 0}, {1.0, 0, 1, 0}, {1.0, 0, 0, 1}, {1.0, 0, 0, 0} };
+    Polynomial s(s_terms);
+    Polynomial sq = s * s;
+    std::vector<Monomial> expected = {
+        {1.0, 2, 0, 0}, {2.0, 1, 1, 0}, {2.0, 1, 0, 1}, {2.0, 1, 0, 0},
+        {1.0, 0, 2, 0}, {2.0, 0, 1, 1}, {2.0, 0, 1, 0},
+        {1.0, 0, 0, 2}, {2.0, 0, 0, 1}, {1.0, 0, 0, 0} };
+    ASSERT_EQ(Polynomial(expected), sq);
+    EXPECT_EQ(expected.size(), sq.getTerms().size());
+    EXPECT_TRUE(std::is_sorted(sq.getTerms().begin(), sq.getTerms().end()));
+
+    //     : (x + 1)(x - 1)(x^2 + 1) = x^4 - 1
+    std::vector<Monomial> a = { {1.0, 1, 0, 0}, {1.0, 0, 0, 0} };
+    std::vector<Monomial> b = { {1.0, 1, 0, 0}, {-1.0, 0, 0, 0} };
+    std::vector<Monomial> c = { {1.0, 2, 0, 0}, {1.0, 0, 0, 0} };
+    std::vector<Monomial> expected2 = { {1.0, 4, 0, 0}, {-1.0, 0, 0, 0} };
+    ASSERT_EQ(Polynomial(expected2), Polynomial(a) * Polynomial(b) * Polynomial(c));
+}
+
+TEST(PolynomialTests, DegreeByVariable) {
+    std::vector<Monomial> p_terms = { {1.0, 3, 1, 0}, {2.0, 1, 4, 2}, {1.0, 0, 0, 7} };
+    Polynomial p(p_terms);
+    EXPECT_EQ(3, p.degree(0));
+    EXPECT_EQ(4, p.degree(1));
+    EXPECT_EQ(7, p.degree(2));
+    EXPECT_EQ(0, Polynomial().degree(1));
+}
+
+TEST(PolynomialTests, MultiplicationKernelsAgree) {
+    std::vector<Monomial> p1_terms = { {1.0, 2, 1, 0}, {-3.0, 1, 0, 2}, {2.0, 0, 3, 0}, {5.0, 0, 0, 0} };
+    std::vector<Monomial> p2_terms = { {4.0, 1, 1, 1}, {1.0, 0, 2, 0}, {-1.0, 0, 0, 0} };
+    Polynomial p1(p1_terms), p2(p2_terms);
+
+    Polynomial heap = p1.multiply(p2, MultiplicationKernel::Heap);
+    Polynomial dense = p1.multiply(p2, MultiplicationKernel::Dense);
+    ASSERT_EQ(heap, dense);
+    ASSERT_EQ(heap, p1 * p2);
+
+    //         
+    std::vector<Monomial> x_terms = { {1.0, 1, 0, 0} };
+    std::vector<Monomial> expected = { {1.0, 2, 0, 0} };
+    ASSERT_EQ(Polynomial(expected), Polynomial(x_terms).multiply(Polynomial(x_terms), MultiplicationKernel::Dense));
+
+    //  :    
+    std::vector<Monomial> cube_terms;
+    for (int a = 0; a <= 4; ++a)
+        for (int b = 0; b <= 4; ++b)
+            for (int c = 0; c <= 4; ++c)
+                cube_terms.push_back(Monomial(1.0 + a - b + 0.5 * c, a, b, c));
+    Polynomial big1(cube_terms), big2 = big1 * 2.0;
+    ASSERT_EQ(big1.multiply(big2, MultiplicationKernel::Heap), big1 * big2);
+
+    ASSERT_THROW(p1.multiply(Polynomial(expected) * Polynomial(expected) * Polynomial(expected) * Polynomial(expected), MultiplicationKernel::Dense), std::out_of_range);
+}
+
+TEST(PolynomialTests, MoveLeavesNoCopies) {
+    EXPECT_TRUE(std::is_nothrow_move_constructible<Polynomial>::value);
+    EXPECT_TRUE(std::is_nothrow_move_assignable<Polynomial>::value);
+
+    //  ,     
+    Polynomial p = makeKeyPolynomial(0, 7, 20, 1.0);
+    Polynomial copy = p;
+    const Monomial* data = p.getTerms().data();
+    Polynomial moved(std::move(p));
+    //        
+    EXPECT_EQ(data, moved.getTerms().data());
+    EXPECT_EQ(copy, moved);
+}
+
+TEST(PolynomialTests, CompoundAssignmentOperators) {
+    std::vector<Monomial> a_terms = { {1.0, 2, 0, 0}, {2.0, 1, 1, 0}, {-1.0, 0, 0, 0} };
+    std::vector<Monomial> b_terms = { {3.0, 3, 0, 0}, {-2.0, 1, 1, 0}, {1.0, 0, 1, 0}, {1.0, 0, 0, 0} };
+    Polynomial a(a_terms), b(b_terms);
+
+    Polynomial sum = a;
+    sum += b;
+    ASSERT_EQ(a + b, sum);
+
+    Polynomial diff = a;
+    diff -= b;
+    ASSERT_EQ(a - b, diff);
+
+    Polynomial prod = a;
+    prod *= b;
+    ASSERT_EQ(a * b, prod);
+
+    Polynomial scaled = a;
+    scaled *= -2.0;
+    ASSERT_EQ(a * -2.0, scaled);
+
+    //    
+    Polynomial self = a;
+    self += self;
+    ASSERT_EQ(a * 2.0, self);
+    self -= self;
+    ASSERT_EQ(Polynomial(), self);
+}
+
+TEST(PolynomialTests, RvalueOperandsReuseBuffer) {
+    std::vector<Monomial> a_terms = { {1.0, 2, 0, 0}, {-1.0, 0, 0, 0} };
+    std::vector<Monomial> b_terms = { {1.0, 1, 0, 0} };
+    Polynomial a(a_terms), b(b_terms);
+
+    ASSERT_EQ(a + b, Polynomial(a) + b);
+    ASSERT_EQ(a + b, a + Polynomial(b));
+    ASSERT_EQ(a + b, Polynomial(a) + Polynomial(b));
+    ASSERT_EQ(a - b, Polynomial(a) - b);
+    ASSERT_EQ(a - b, a - Polynomial(b));
+    ASSERT_EQ(a - b, Polynomial(a) - Polynomial(b));
+    ASSERT_EQ(a * 3.0, Polynomial(a) * 3.0);
+
+    //   :   ,     
+    Polynomial total;
+    int reallocations = 0;
+    const Monomial* data = total.getTerms().data();
+    for (int key = 0; key < 1000; ++key) {
+        std::vector<Monomial> term = { Monomial::fromKey(1.0, key) };
+        total += Polynomial(term);
+        if (total.getTerms().data() != data) {
+            reallocations++;
+            data = total.getTerms().data();
+        }
+    }
+    EXPECT_EQ(1000u, total.getTerms().size());
+    EXPECT_LT(reallocations, 20);
+    EXPECT_TRUE(std::is_sorted(total.getTerms().begin(), total.getTerms().end()));
+}
+
+TEST(PolynomialTests, ShortPolynomialsStayInline) {
+    std::vector<Monomial> p_terms = { {1.0, 2, 0, 0}, {3.0, 0, 1, 0}, {-1.0, 0, 0, 0} };
+    Polynomial p(p_terms);
+    EXPECT_TRUE(p.getTerms().isInline());
+    EXPECT_TRUE((p * p).getTerms().isInline());  // 6 
+    EXPECT_TRUE((p + p).getTerms().isInline());
+
+    //          
+    Polynomial big = makeKeyPolynomial(0, 11, SMALL_TERMS_CAPACITY + 5, 1.0);
+    EXPECT_FALSE(big.getTerms().isInline());
+    EXPECT_EQ(SMALL_TERMS_CAPACITY + 5, big.getTerms().size());
+    EXPECT_TRUE(std::is_sorted(big.getTerms().begin(), big.getTerms().end()));
+
+    Polynomial copy = big;
+    EXPECT_EQ(big, copy);
+    Polynomial small_copy = p;
+    small_copy = big;
+    EXPECT_EQ(big, small_copy);
+    small_copy = p;
+    EXPECT_EQ(p, small_copy);
+}
+
+TEST(TSmallVectorTests, GrowEraseAppend) {
+    TSmallVector<int, 3> v;
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_FALSE(v.isInline());
+    EXPECT_EQ(10u, v.size());
+    v.erase(v.begin() + 2, v.begin() + 5); // 0 1 5 6 7 8 9
+    EXPECT_EQ(7u, v.size());
+    EXPECT_EQ(5, v[2]);
+
+    TSmallVector<int, 3> w;
+    w.append(v.begin(), v.begin() + 2);
+    EXPECT_TRUE(w.isInline());
+    TSmallVector<int, 3> moved(std::move(v));
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(9, moved.back());
+    moved = std::move(w);
+    EXPECT_EQ(2u, moved.size());
+    EXPECT_EQ(1, moved.back());
+}
+
+TEST(PolynomialExpressionTests, FusedExpressionMatchesStepByStep) {
+    std::vector<Monomial> a_terms = { {1.0, 2, 0, 0}, {-3.0, 0, 1, 0}, {2.0, 0, 0, 0} };
+    std::vector<Monomial> b_terms = { {1.0, 1, 0, 0}, {1.0, 0, 0, 1} };
+    std::vector<Monomial> c_terms = { {2.0, 1, 1, 0}, {-1.0, 0, 0, 0} };
+    std::vector<Monomial> d_terms = { {4.0, 2, 1, 0}, {1.0, 0, 1, 0} };
+    Polynomial a(a_terms), b(b_terms), c(c_terms), d(d_terms);
+
+    Polynomial fused = lazy(a) + lazy(b) * c - d;
+    ASSERT_EQ(a + b * c - d, fused);
+
+    //        
+    Polynomial nested = (lazy(a) + b) * (lazy(c) - d) * 2.0 - a;
+    ASSERT_EQ((a + b) * (c - d) * 2.0 - a, nested);
+
+    //   
+    Polynomial zero = lazy(a) - a;
+    ASSERT_EQ(Polynomial(), zero);
+    ASSERT_EQ(a * b, evaluate(lazy(a) * b));
+}
+
+TEST(PolynomialExpressionTests, DegreeOverflowThrowsOnEvaluation) {
+    std::vector<Monomial> x5_terms = { {1.0, 5, 0, 0} };
+    Polynomial x5(x5_terms);
+    ASSERT_THROW(evaluate(lazy(x5) * x5 + x5), std::out_of_range);
+}
+
+TEST(PolynomialTests, DeferredAdditionNormalizesOnObservation) {
+    std::vector<Monomial> a_terms = { {1.0, 2, 0, 0}, {2.0, 0, 1, 0} };
+    std::vector<Monomial> b_terms = { {-2.0, 0, 1, 0}, {3.0, 0, 0, 0} };
+    Polynomial a(a_terms), b(b_terms);
+
+    Polynomial acc;
+    acc.deferredAdd(a);
+    EXPECT_FALSE(acc.isNormalized());
+    acc += b;                //  
+    acc -= a;
+    acc.deferredSubtract(b);
+    acc += a;
+    EXPECT_FALSE(acc.isNormalized());
+
+    //     
+    EXPECT_EQ(a, acc);
+    EXPECT_TRUE(acc.isNormalized());
+
+    //     
+    Polynomial lazy_sum;
+    for (int i = 0; i < 100; ++i) {
+        lazy_sum.deferredAdd(b);
+    }
+    Polynomial stored = lazy_sum;
+    EXPECT_TRUE(stored.isNormalized());
+    EXPECT_EQ(b * 100.0, stored);
+
+    //     
+    Polynomial printed;
+    printed.deferredAdd(a).deferredAdd(a);
+    std::ostringstream out;
+    out << printed;
+    EXPECT_EQ("2*x^2 + 4*y", out.str());
+}
+
+TEST(PolynomialTests, PowerMatchesRepeatedMultiplication) {
+    Polynomial p({ Monomial(1.0, 1, 0, 0), Monomial(-2.0, 0, 1, 1), Monomial(3.0, 0, 0, 0) });
+    Polynomial expected({ Monomial(1.0, 0, 0, 0) });
+    for (int k = 0; k <= 4; ++k) {
+        EXPECT_EQ(p.pow(k), expected);
+        expected = expected * p;
+    }
+}
+
+TEST(PolynomialTests, PowerChecksDegreeBeforeMultiplying) {
+    Polynomial p({ Monomial(1.0, 2, 0, 0), Monomial(1.0, 0, 3, 0) });
+    EXPECT_NO_THROW(p.pow(3));
+    EXPECT_THROW(p.pow(4), std::out_of_range);
+    EXPECT_THROW(p.pow(-1), std::runtime_error);
+    EXPECT_EQ(Polynomial({ Monomial(2.0, 0, 0, 0) }).pow(10), Polynomial({ Monomial(1024.0, 0, 0, 0) }));
+}
 
+TEST(PolynomialTests, TranslatorAppliesPowerToGroups) {
+    Polynomial group = parsePolynomial("x+y");
+    EXPECT_EQ(PolynomialTranslyator("(x+y)^3").calculate(), group.pow(3));
+    EXPECT_EQ(PolynomialTranslyator("2*(x+y)^2 - x^2").calculate(), group.pow(2) * 2.0 - parsePolynomial("x^2"));
+    EXPECT_EQ(PolynomialTranslyator("((x+y)^2)^2").calculate(), group.pow(4));
+    EXPECT_EQ(PolynomialTranslyator("(x+y) ^ 2").getTokens().size(), 7u);
+    EXPECT_THROW(PolynomialTranslyator("(x+y)^"), std::runtime_error);
+    EXPECT_THROW(PolynomialTranslyator("(x+y)^y"), std::runtime_error);
+    EXPECT_THROW(PolynomialTranslyator("(x^5)^2").calculate(), std::out_of_range);
+}
+
+TEST(PolynomialTests, TruncatedMultiplicationDropsHighDegrees) {
+    Polynomial p = parsePolynomial("x^5+y+1");
+    Polynomial q = parsePolynomial("x^5-y");
+    EXPECT_THROW(p * q, std::out_of_range);
+    EXPECT_EQ(p.multiplyTruncated(q), parsePolynomial("x^5-y^2-y"));
+
+    Polynomial r = parsePolynomial("x+y+z+1");
+    EXPECT_EQ(r.multiplyTruncated(r), r * r);
+    EXPECT_EQ(r.multiplyTruncated(r, 1), parsePolynomial("2x+2y+2z+1"));
+    EXPECT_EQ(r.multiplyTruncated(r, 0), parsePolynomial("1"));
+}
+
+TEST(PolynomialTests, CanonicalizeMergesUnsortedDuplicates) {
+    //    ,  -   
+    for (int count : { 5, 200 }) {
+        std::vector<Monomial> monomials;
+        for (int i = 0; i < count; ++i) {
+            int key = (i * 37) % 50;
+            monomials.push_back(Monomial::fromKey(i % 2 == 0 ? 1.0 : -1.0, key));
+            monomials.push_back(Monomial::fromKey(2.0, key));
+        }
+        DensePolynomial expected;
+        for (const auto& m : monomials) {
+            expected[m.key] += m.coeff;
+        }
+        Polynomial p(monomials);
+        EXPECT_EQ(p, Polynomial(expected));
+        const TermList& terms = p.getTerms();
+        for (size_t i = 1; i < terms.size(); ++i) {
+            EXPECT_GT(terms[i - 1].key, terms[i].key);
+        }
+    }
+}
 
+TEST(TSmallVectorTests, CopiesShareHeapBufferUntilWrite) {
+    TermList a;
+    for (int i = 0; i < 20; ++i) {
+        a.push_back(Monomial::fromKey(1.0, 100 - i));
+    }
+    TermList b = a;
+    EXPECT_TRUE(a.isShared());
+    EXPECT_EQ(static_cast<const TermList&>(a).data(), static_cast<const TermList&>(b).data());
+
+    b[0].coeff = 5.0;
+    EXPECT_FALSE(a.isShared());
+    EXPECT_FALSE(b.isShared());
+    EXPECT_DOUBLE_EQ(a[0].coeff, 1.0);
+    EXPECT_DOUBLE_EQ(b[0].coeff, 5.0);
+}
+
+TEST(PolynomialTests, CopiesShareTermsUntilModified) {
+    Polynomial a = makeKeyPolynomial(0, 7, 20, 1.0);
+    Polynomial b = a;
+    Polynomial c = b;
+    EXPECT_EQ(a.getTerms().data(), c.getTerms().data());
+    EXPECT_EQ(b.degree(1), a.degree(1)); //    
+    EXPECT_EQ(a.getTerms().data(), b.getTerms().data());
+
+    //      
+    Polynomial deferred = makeKeyPolynomial(1, 7, 3, 1.0);
+    deferred.deferredAdd(a);
+    deferred.deferredSubtract(b);
+    Polynomial accumulated = makeKeyPolynomial(1, 7, 3, 1.0);
+    accumulated += a;
+    Polynomial sum = a + b;
+    EXPECT_EQ(a.getTerms().data(), b.getTerms().data());
+    EXPECT_EQ(a.getTerms().data(), c.getTerms().data());
+    EXPECT_EQ(deferred, makeKeyPolynomial(1, 7, 3, 1.0));
+    EXPECT_EQ(accumulated - a, makeKeyPolynomial(1, 7, 3, 1.0));
+    EXPECT_EQ(sum, a * 2.0);
+
+    //      
+    TermList low_terms;
+    for (int key = 0; key < 500; ++key) {
+        if (key % 10 < 5 && key / 10 % 10 < 5) low_terms.push_back(Monomial::fromKey(1.0, key));
+    }
+    Polynomial f(low_terms);
+    Polynomial g = f;
+    Polynomial product = f * g;
+    EXPECT_EQ(f.getTerms().data(), g.getTerms().data());
+    EXPECT_EQ(product, f.multiply(f, MultiplicationKernel::Heap));
+
+    b += Polynomial({ Monomial(1.0, 0, 0, 0) });
+    c *= 2.0;
+    EXPECT_NE(a.getTerms().data(), b.getTerms().data());
+    EXPECT_NE(a.getTerms().data(), c.getTerms().data());
+    EXPECT_EQ(a, makeKeyPolynomial(0, 7, 20, 1.0));
+    EXPECT_EQ(c, a * 2.0);
+    EXPECT_EQ(b - a, Polynomial({ Monomial(1.0, 0, 0, 0) }));
+}
 
+TEST(CoefficientTypeTests, Int64CoefficientsAreExact) {
+    using IntPolynomial = TPolynomial<int64_t>;
+    IntPolynomial p = parsePolynomial<int64_t>("3x^2 - 2x*y + 7");
+    IntPolynomial q = parsePolynomial<int64_t>("x - 1");
+    EXPECT_EQ(p * q, parsePolynomial<int64_t>("3x^3 - 3x^2 - 2x^2*y + 2x*y + 7x - 7"));
+    EXPECT_EQ(p * 2, p + p);
+    EXPECT_EQ(std::hash<IntPolynomial>()(p), std::hash<IntPolynomial>()(parsePolynomial<int64_t>("7 + 3x^2 - 2x*y")));
+    EXPECT_THROW(parsePolynomial<int64_t>("2.5x"), std::runtime_error);
+
+    std::ostringstream out;
+    out << p;
+    EXPECT_EQ(out.str(), "3*x^2 - 2*x*y + 7");
+}
 
+TEST(CoefficientTypeTests, ModularCoefficientsWrapAround) {
+    using Mod7 = ModInt<7>;
+    TPolynomial<Mod7> p = parsePolynomial<Mod7>("x + 1");
+    //    7: (x + 1)^7 = x^7 + 1
+    EXPECT_EQ(p.pow(7), parsePolynomial<Mod7>("x^7 + 1"));
+    EXPECT_EQ(parsePolynomial<Mod7>("5x") + parsePolynomial<Mod7>("2x"), TPolynomial<Mod7>());
+    EXPECT_EQ(parsePolynomial<Mod7>("-x"), parsePolynomial<Mod7>("6x"));
+
+    ModInt<> big = ModInt<>(-1);
+    EXPECT_EQ(big.value(), DEFAULT_MODULUS - 1);
+    EXPECT_EQ((big * big).value(), 1u);
+    EXPECT_EQ((big + ModInt<>(1)).value(), 0u);
+}
 
+TEST(CoefficientTypeTests, FloatPolynomialsUseHalfTheStorage) {
+    EXPECT_EQ(sizeof(TMonomial<float>), 8u);
+    TPolynomial<float> p = parsePolynomial<float>("0.5x + 1.5y");
+    TPolynomial<float> expected = parsePolynomial<float>("0.25x^2 + 1.5x*y + 2.25y^2");
+    EXPECT_EQ(p * p, expected);
+    TPolynomial<float> fused = lazy(p) * p - expected;
+    EXPECT_EQ(fused, TPolynomial<float>());
+}
 
+TEST(CoefficientTypeTests, TranslatorUsesConfiguredCoefficientType) {
+    TPolynomialTranslyator<int64_t> translator("(x+2)^2*3 - x");
+    EXPECT_EQ(translator.calculate(), parsePolynomial<int64_t>("3x^2 + 11x + 12"));
+    EXPECT_THROW(TPolynomialTranslyator<int64_t>("0.5*x").calculate(), std::runtime_error);
+}
+
+TEST(PolynomialLayoutTests, FourVariablesPackIntoSixteenBits) {
+    using Poly4 = PolynomialN<4, 6>;
+    EXPECT_EQ(sizeof(Poly4::key_type), 2u);
+    EXPECT_TRUE(Poly4::Layout::DENSE);
+    auto parse4 = [](const std::string& str) { return parsePolynomial<double, Poly4::Layout>(str); };
+
+    Poly4 p = parse4("x*w^2 + 2z - 1");
+    Poly4 q = parse4("w^4 + y");
+    EXPECT_EQ(p.degree(3), 2);
+    EXPECT_EQ(p * q, parse4("x*w^6 + x*y*w^2 + 2z*w^4 + 2y*z - w^4 - y"));
+    EXPECT_THROW(q * q, std::out_of_range);
+    EXPECT_THROW(parse4("w^7"), std::out_of_range);
+
+    std::ostringstream out;
+    out << p;
+    EXPECT_EQ(out.str(), "x*w^2 + 2*z - 1");
+    Poly4 built({ Poly4::Monomial(1.0, { 1, 0, 0, 2 }), Poly4::Monomial(2.0, { 0, 0, 1 }), Poly4::Monomial(-1.0) });
+    EXPECT_EQ(p, built);
+}
+
+TEST(PolynomialLayoutTests, LargeKeySpaceUsesSparseKernels) {
+    using Poly6 = PolynomialN<6, 12>;
+    EXPECT_EQ(sizeof(Poly6::key_type), 4u);
+    EXPECT_FALSE(Poly6::Layout::DENSE);
+    auto parse6 = [](const std::string& str) { return parsePolynomial<double, Poly6::Layout>(str); };
+
+    Poly6 p = parse6("x + y + z + w + u + v");
+    Poly6 square = p * p;
+    EXPECT_EQ(square.getTerms().size(), 21u);
+    EXPECT_EQ(square, p.pow(2));
+    Poly6 fused = lazy(p) * p - square;
+    EXPECT_EQ(fused, Poly6());
+    EXPECT_EQ(p.multiplyTruncated(square, 2), Poly6());
+    EXPECT_EQ(parse6("v^12").multiplyTruncated(p), parse6("x*v^12 + y*v^12 + z*v^12 + w*v^12 + u*v^12"));
+
+    std::ostringstream out;
+    out << parse6("3u^11*v^10 - x");
+    EXPECT_EQ(out.str(), "-x + 3*u^11*v^10");
+    EXPECT_THROW(parse6("u^13"), std::out_of_range);
+    EXPECT_THROW(parsePolynomial("w"), std::runtime_error);
+}
+
+TEST(HighDegreeTests, FftMatchesSchoolbookMultiplication) {
+    using Poly = PolynomialN<2, 200>;
+    Poly::TermList a_terms, b_terms;
+    for (int i = 0; i <= 60; ++i) {
+        for (int j = 0; j <= 40; j += 3) {
+            a_terms.push_back(Poly::Monomial(((i + j) % 9) - 4.0, { i, j }));
+            b_terms.push_back(Poly::Monomial(0.5 * ((i * j) % 5) + 1.0, { 2 * i, j + 1 }));
+        }
+    }
+    Poly a(a_terms), b(b_terms);
+    Poly heap = a.multiply(b, MultiplicationKernel::Heap);
+    EXPECT_EQ(a.multiply(b, MultiplicationKernel::Fft), heap);
+    EXPECT_EQ(a * b, heap);
+    EXPECT_EQ(heap.degree(0), 180);
+    EXPECT_THROW(heap * heap, std::out_of_range);
+}
+
+TEST(HighDegreeTests, AutoKernelMatchesHeapForLargeCoefficients) {
+    //      :    30
+    //   EPSILON,       
+    using Poly = PolynomialN<2, 200>;
+    Poly::TermList a_terms, b_terms;
+    for (int i = 0; i < 60; ++i) {
+        for (int j = 0; j < 60; ++j) {
+            a_terms.push_back(Poly::Monomial(std::sin(1.0 + i * 31 + j), { i, j }));
+            b_terms.push_back(Poly::Monomial(std::cos(2.0 + i * 17 + j), { j, i }));
+        }
+    }
+    Poly a = Poly(a_terms) * 30.0, b = Poly(b_terms) * 30.0;
+    EXPECT_EQ(a * b, a.multiply(b, MultiplicationKernel::Heap));
+
+    //    1  ,    
+    Poly small_a = a * (1.0 / 30), small_b = b * (1.0 / 30);
+    EXPECT_EQ(small_a * small_b, small_a.multiply(small_b, MultiplicationKernel::Heap));
+}
+
+TEST(HighDegreeTests, FftDropsCancelledTerms) {
+    using Poly = PolynomialN<1, 4000>;
+    Poly::TermList ones;
+    for (int i = 0; i < 2000; ++i) {
+        ones.push_back(Poly::Monomial(1.0, { i }));
+    }
+    Poly geometric(ones);
+    Poly x_minus_one({ Poly::Monomial(1.0, { 1 }), Poly::Monomial(-1.0) });
+    // (1 + x + ... + x^1999)(x - 1) = x^2000 - 1:    
+    Poly expected({ Poly::Monomial(1.0, { 2000 }), Poly::Monomial(-1.0) });
+    EXPECT_EQ(geometric.multiply(x_minus_one, MultiplicationKernel::Fft).getTerms().size(), 2u);
+    EXPECT_EQ(geometric.multiply(x_minus_one, MultiplicationKernel::Fft), expected);
+    EXPECT_EQ(geometric * geometric, geometric.multiply(geometric, MultiplicationKernel::Heap));
+}
 
+TEST(HighDegreeTests, ExactCoefficientsIgnoreFftKernel) {
+    using IntPoly = TPolynomial<int64_t, MonomialLayout<1, 1000>>;
+    IntPoly::TermList terms;
+    for (int i = 0; i < 300; ++i) {
+        terms.push_back(IntPoly::Monomial(1 + i % 7, { i }));
+    }
+    IntPoly p(terms);
+    EXPECT_EQ(p.multiply(p, MultiplicationKernel::Fft), p.multiply(p, MultiplicationKernel::Heap));
+
+    //  :  double      
+    using ModPoly = TPolynomial<ModInt<>, MonomialLayout<1, 1000>>;
+    ModPoly::TermList mod_terms;
+    for (int i = 0; i < 300; ++i) {
+        mod_terms.push_back(ModPoly::Monomial(ModInt<>(-1 - i), { i }));
+    }
+    ModPoly q(mod_terms);
+    EXPECT_EQ(q.multiply(q, MultiplicationKernel::Fft), q.multiply(q, MultiplicationKernel::Heap));
+}
+
+//   :  coeff * x^px * y^py * z^pz
+template<class Poly, class TPoint>
+static double evaluateNaive(const Poly& p, const TPoint& point) {
+    double result = 0;
+    for (const auto& term : p.getTerms()) {
+        double value = term.coeff;
+        for (int var = 0; var < Poly::VARIABLES; ++var) {
+            value *= std::pow(point[var], term.exponent(var));
+        }
+        result += value;
+    }
+    return result;
+}
+
+TEST(PolynomialEvaluateTests, MatchesTermByTermSum) {
+    Polynomial p = parsePolynomial("3x^9*y^2 - x^4*z^7 + 0.5x^4*y + 2x*y^3*z - y^9 + 7z - 4");
+    std::array<double, 3> point = { 1.1, -0.7, 0.9 };
+    EXPECT_NEAR(p.evaluate(1.1, -0.7, 0.9), evaluateNaive(p, point), 1e-12);
+    EXPECT_NEAR(p.evaluate(point), evaluateNaive(p, point), 1e-12);
+    EXPECT_EQ(p.evaluate(0.0, 0.0, 0.0), -4.0);
+    EXPECT_EQ(Polynomial().evaluate(1.0, 2.0, 3.0), 0.0);
+    EXPECT_EQ(parsePolynomial("x*y*z").evaluate(2.0, 3.0, 5.0), 30.0);
+}
+
+TEST(PolynomialEvaluateTests, WorksForAnyLayout) {
+    using Poly6 = PolynomialN<6, 12>;
+    Poly6 p = parsePolynomial<double, Poly6::Layout>("x^12*v - 2y*w^3*u + z^5 + u^2*v^11 - 1");
+    std::array<double, 6> point = { 0.9, 1.2, -1.1, 0.5, 2.0, -0.8 };
+    EXPECT_NEAR(p.evaluate(point), evaluateNaive(p, point), 1e-12);
+
+    //   :     
+    using Univariate = PolynomialN<1, 4000>;
+    Univariate::TermList terms;
+    for (int i = 0; i <= 4000; i += 7) {
+        terms.push_back(Univariate::Monomial(1.0 / (1 + i % 13), { i }));
+    }
+    Univariate q(terms);
+    std::array<double, 1> x = { 0.999 };
+    EXPECT_NEAR(q.evaluate(0.999), evaluateNaive(q, x), 1e-10);
+
+    TPolynomial<int64_t> exact = parsePolynomial<int64_t>("2x^3*y - 5y*z^2 + 9");
+    EXPECT_EQ(exact.evaluate(3, -2, 4), 2 * 27 * -2 - 5 * -2 * 16 + 9);
+}
+
+TEST(PolynomialEvaluateTests, BatchMatchesPointwiseEvaluation) {
+    TermList terms;
+    for (int key = 0; key < MONOMIAL_KEY_COUNT; key += 3) {
+        terms.push_back(Monomial::fromKey(0.01 * (key % 17) - 0.08, key));
+    }
+    Polynomial p(terms);
+    const size_t n = 203; //    ,   
+    std::vector<double> xs(n), ys(n), zs(n), out(n);
+    for (size_t j = 0; j < n; ++j) {
+        xs[j] = -1.0 + 0.01 * j;
+        ys[j] = 0.5 + 0.003 * j;
+        zs[j] = 1.2 - 0.004 * j;
+    }
+    p.evaluateBatch(xs.data(), ys.data(), zs.data(), out.data(), n);
+    for (size_t j = 0; j < n; ++j) {
+        EXPECT_NEAR(out[j], p.evaluate(xs[j], ys[j], zs[j]), 1e-9);
+    }
+
+    Polynomial constant = parsePolynomial("2.5");
+    constant.evaluateBatch(xs.data(), ys.data(), zs.data(), out.data(), n);
+    EXPECT_EQ(out[n - 1], 2.5);
+}
+
+TEST(PolynomialEvaluateTests, BatchWorksForAnyLayoutAndCoefficient) {
+    using Poly6 = PolynomialN<6, 12>;
+    Poly6 p = parsePolynomial<double, Poly6::Layout>("x^12*v - 2y*w^3*u + z^5 + u^2*v^11 - 1");
+    std::vector<std::vector<double>> coords(6, std::vector<double>(50));
+    std::array<const double*, 6> ptrs;
+    for (int var = 0; var < 6; ++var) {
+        for (size_t j = 0; j < 50; ++j) {
+            coords[var][j] = 0.9 + 0.01 * var - 0.002 * j;
+        }
+        ptrs[var] = coords[var].data();
+    }
+    std::vector<double> out(50);
+    p.evaluateBatch(ptrs, out.data(), out.size());
+    for (size_t j = 0; j < 50; ++j) {
+        std::array<double, 6> point;
+        for (int var = 0; var < 6; ++var) point[var] = coords[var][j];
+        EXPECT_NEAR(out[j], p.evaluate(point), 1e-12);
+    }
+
+    TPolynomial<int64_t> exact = parsePolynomial<int64_t>("2x^3*y - 5y*z^2 + 9");
+    std::vector<int64_t> xs = { 3, -1, 0 }, ys = { -2, 4, 1 }, zs = { 4, 2, -3 }, exact_out(3);
+    exact.evaluateBatch(xs.data(), ys.data(), zs.data(), exact_out.data(), 3);
+    for (size_t j = 0; j < 3; ++j) {
+        EXPECT_EQ(exact_out[j], exact.evaluate(xs[j], ys[j], zs[j]));
+    }
+}
+
+TEST(PolynomialDerivativeTests, DifferentiatesByEachVariable) {
+    Polynomial p = parsePolynomial("3x^4*y^2 - 2x*z + 5y^3 + 7");
+    EXPECT_EQ(p.derivative(0), parsePolynomial("12x^3*y^2 - 2z"));
+    EXPECT_EQ(p.derivative(1), parsePolynomial("6x^4*y + 15y^2"));
+    EXPECT_EQ(p.derivative(2), parsePolynomial("-2x"));
+    EXPECT_TRUE(parsePolynomial("7").derivative(0).getTerms().empty());
+    EXPECT_THROW(p.derivative(3), std::out_of_range);
+    EXPECT_THROW(p.derivative(-1), std::out_of_range);
+
+    using Poly6 = PolynomialN<6, 12>;
+    Poly6 q = parsePolynomial<double, Poly6::Layout>("x^12*v - 2y*w^3*u + u^2*v^11");
+    Poly6 expected = parsePolynomial<double, Poly6::Layout>("-2y*w^3 + 2u*v^11");
+    EXPECT_EQ(q.derivative(4), expected);
+}
+
+TEST(PolynomialDerivativeTests, BatchMatchesDerivativePolynomials) {
+    TermList terms;
+    for (int key = 0; key < MONOMIAL_KEY_COUNT; key += 7) {
+        terms.push_back(Monomial::fromKey(0.01 * (key % 19) - 0.09, key));
+    }
+    Polynomial p(terms);
+    const size_t n = 203;
+    std::vector<double> xs(n), ys(n), zs(n), values(n), gradients(3 * n), hessians(9 * n);
+    for (size_t j = 0; j < n; ++j) {
+        xs[j] = -1.0 + 0.01 * j;
+        ys[j] = 0.5 + 0.003 * j;
+        zs[j] = 1.2 - 0.004 * j;
+    }
+    p.evaluateDerivativesBatch(xs.data(), ys.data(), zs.data(), values.data(), gradients.data(), hessians.data(), n);
+    for (size_t j = 0; j < n; ++j) {
+        EXPECT_NEAR(values[j], p.evaluate(xs[j], ys[j], zs[j]), 1e-9);
+        for (int a = 0; a < 3; ++a) {
+            Polynomial first = p.derivative(a);
+            EXPECT_NEAR(gradients[a * n + j], first.evaluate(xs[j], ys[j], zs[j]), 1e-8);
+            for (int b = 0; b < 3; ++b) {
+                EXPECT_NEAR(hessians[(a * 3 + b) * n + j], first.derivative(b).evaluate(xs[j], ys[j], zs[j]), 1e-7);
+            }
+        }
+    }
+
+    //        
+    std::vector<double> gradients_only(3 * n);
+    p.evaluateDerivativesBatch(xs.data(), ys.data(), zs.data(), values.data(), gradients_only.data(), nullptr, n);
+    EXPECT_EQ(gradients_only, gradients);
+}
+
+TEST(PolynomialDerivativeTests, BatchWorksForAnyLayoutAndCoefficient) {
+    TPolynomial<int64_t> exact = parsePolynomial<int64_t>("2x^3*y - 5y*z^2 + 9");
+    std::vector<int64_t> xs = { 3, -1 }, ys = { -2, 4 }, zs = { 4, 2 }, values(2), gradients(6), hessians(18);
+    exact.evaluateDerivativesBatch(xs.data(), ys.data(), zs.data(), values.data(), gradients.data(), hessians.data(), 2);
+    //   (3, -2, 4): grad = (6x^2*y, 2x^3 - 5z^2, -10y*z)
+    EXPECT_EQ(values[0], exact.evaluate(3, -2, 4));
+    EXPECT_EQ(gradients[0], 6 * 9 * -2);
+    EXPECT_EQ(gradients[2], 2 * 27 - 5 * 16);
+    EXPECT_EQ(gradients[4], -10 * -2 * 4);
+    EXPECT_EQ(hessians[(0 * 3 + 1) * 2], 6 * 9);
+    EXPECT_EQ(hessians[(1 * 3 + 0) * 2], 6 * 9);
+    EXPECT_EQ(hessians[(2 * 3 + 2) * 2], -10 * -2);
+    EXPECT_EQ(hessians[(1 * 3 + 1) * 2 + 1], 0);
+
+    //  :    
+    using Univariate = PolynomialN<1, 4000>;
+    Univariate q = parsePolynomial<double, Univariate::Layout>("x^4000 - 3x^2 + x");
+    std::array<const double*, 1> coords;
+    std::vector<double> x = { 0.999, -0.5 }, value(2), gradient(2), hessian(2);
+    coords[0] = x.data();
+    q.evaluateDerivativesBatch(coords, value.data(), gradient.data(), hessian.data(), 2);
+    for (size_t j = 0; j < 2; ++j) {
+        EXPECT_NEAR(value[j], q.evaluate(x[j]), 1e-10);
+        EXPECT_NEAR(gradient[j], 4000 * std::pow(x[j], 3999) - 6 * x[j] + 1, 1e-8);
+        EXPECT_NEAR(hessian[j], 4000.0 * 3999 * std::pow(x[j], 3998) - 6, 1e-3);
+    }
+}
+
+TEST(PolynomialExpressionTests, NestedScratchUseKeepsAccumulatedTerms) {
+    std::vector<Monomial> c_terms = { {2.0, 1, 0, 0}, {-1.0, 0, 0, 0} };
+    std::vector<Monomial> d_terms = { {4.0, 2, 1, 0}, {1.0, 0, 1, 0} };
+    Polynomial c(c_terms), d(d_terms);
+
+    //      ,  
+    //     d
+    Polynomial deferred, expected;
+    for (int i = 0; i < 40; ++i) {
+        std::vector<Monomial> term = { {1.0 + i, i % 5, (i / 5) % 5, 0} };
+        Polynomial p(term);
+        deferred.deferredAdd(p);
+        expected += p;
+    }
+    ASSERT_FALSE(deferred.isNormalized());
+    Polynomial fused = lazy(d) + lazy(deferred) * c;
+    ASSERT_EQ(d + expected * c, fused);
+    ASSERT_TRUE(fused.isNormalized());
+}
+
+TEST(PolynomialExpressionTests, FailedEvaluationLeavesScratchClean) {
+    std::vector<Monomial> b_terms = { {1.0, 1, 0, 0}, {2.0, 0, 0, 3} };
+    std::vector<Monomial> x5_terms = { {1.0, 5, 0, 0} };
+    Polynomial b(b_terms), x5(x5_terms);
+
+    // b       
+    ASSERT_THROW(evaluate(lazy(b) + lazy(x5) * x5), std::out_of_range);
+    Polynomial zero = lazy(x5) - x5;
+    ASSERT_EQ(Polynomial(), zero);
+    ASSERT_EQ(b * 3.0, evaluate(lazy(b) * 3.0));
+}
@@ -0,0 +1,68 @@
+#include "gtest.h"
+#include "PolynomialGrid.h"
+#include "Parser.h"
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+static const GridBounds unitBounds = { { -1.0, -0.5, 0.0 }, { 1.0, 1.5, 2.0 } };
+
+TEST(PolynomialGridTests, MatchesPointwiseEvaluation) {
+    Polynomial p = parsePolynomial("3x^9*y^2 - x^4*z^7 + 0.5x^4*y + 2x*y^3*z - y^9 + 7z - 4");
+    const size_t nx = 5, ny = 4, nz = 7;
+    std::vector<double> values = evaluateGrid(p, nx, ny, nz, unitBounds);
+    ASSERT_EQ(values.size(), nx * ny * nz);
+    std::vector<double> xs = gridAxis<double>(unitBounds, 0, nx);
+    std::vector<double> ys = gridAxis<double>(unitBounds, 1, ny);
+    std::vector<double> zs = gridAxis<double>(unitBounds, 2, nz);
+    EXPECT_EQ(xs.front(), -1.0);
+    EXPECT_EQ(xs.back(), 1.0);
+    for (size_t ix = 0; ix < nx; ++ix) {
+        for (size_t iy = 0; iy < ny; ++iy) {
+            for (size_t iz = 0; iz < nz; ++iz) {
+                EXPECT_NEAR(values[(ix * ny + iy) * nz + iz], p.evaluate(xs[ix], ys[iy], zs[iz]), 1e-9);
+            }
+        }
+    }
+}
+
+TEST(PolynomialGridTests, HandlesDegenerateGridsAndLayouts) {
+    EXPECT_EQ(evaluateGrid(Polynomial(), 2, 2, 2, unitBounds), std::vector<double>(8, 0.0));
+    EXPECT_TRUE(evaluateGrid(parsePolynomial("x"), 0, 3, 3, unitBounds).empty());
+    // Один узел по оси - в нижней границе
+    EXPECT_EQ(evaluateGrid(parsePolynomial("x + 2y + 3z"), 1, 1, 1, unitBounds)[0], -1.0 - 1.0 + 0.0);
+
+    using Poly2 = PolynomialN<2, 5>;
+    Poly2 plane = parsePolynomial<double, Poly2::Layout>("x^5*y - y^2 + 1");
+    std::vector<double> values = evaluateGrid(plane, 3, 3, 2, unitBounds);
+    std::vector<double> xs = gridAxis<double>(unitBounds, 0, 3), ys = gridAxis<double>(unitBounds, 1, 3);
+    for (size_t ix = 0; ix < 3; ++ix) {
+        for (size_t iy = 0; iy < 3; ++iy) {
+            EXPECT_NEAR(values[(ix * 3 + iy) * 2], plane.evaluate(xs[ix], ys[iy]), 1e-12);
+            EXPECT_EQ(values[(ix * 3 + iy) * 2], values[(ix * 3 + iy) * 2 + 1]);
+        }
+    }
+}
+
+TEST(PolynomialGridTests, StreamsSlicesAsBinary) {
+    TPolynomial<float> p = parsePolynomial<float>("x*y*z - 2x^2 + 0.5");
+    std::vector<float> values = evaluateGrid(p, 4, 3, 2, unitBounds);
+    std::ostringstream out(std::ios::binary);
+    writeGrid(p, 4, 3, 2, unitBounds, out);
+    std::string bytes = out.str();
+    ASSERT_EQ(bytes.size(), values.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(bytes.data(), values.data(), bytes.size()), 0);
+
+    const std::string path = "test_polynomial_grid.bin";
+    saveGrid(p, 4, 3, 2, unitBounds, path);
+    std::ifstream file(path, std::ios::binary);
+    std::string saved((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(path.c_str());
+    EXPECT_EQ(saved, bytes);
+
+    EXPECT_THROW(saveGrid(p, 1, 1, 1, unitBounds, "no_such_dir/grid.bin"), std::runtime_error);
+}
@@ -0,0 +1,66 @@
+﻿#include "gtest.h"
+#include "PolynomialPool.h"
+#include "ChainHashTable.h"
+#include "HashTableOpenAddressing.h"
+#include "Parser.h"
+#include <string>
+
+TEST(PolynomialHashTests, EqualPolynomialsHashEqually) {
+    std::hash<Polynomial> hasher;
+    Polynomial a = parsePolynomial("x^2+2y-z");
+    Polynomial b = parsePolynomial("-z+2y+x^2");
+    Polynomial c;
+    c.deferredAdd(parsePolynomial("2y"));
+    c.deferredAdd(parsePolynomial("x^2-z"));
+    EXPECT_EQ(hasher(a), hasher(b));
+    EXPECT_EQ(hasher(a), hasher(c));
+    EXPECT_EQ(hasher(a), hasher(a + Polynomial({ Monomial(1e-12, 1, 0, 0) })));
+    EXPECT_NE(hasher(a), hasher(parsePolynomial("x^2+2y+z")));
+    EXPECT_EQ(hasher(Polynomial()), hasher(a - b));
+}
+
+TEST(PolynomialHashTests, PolynomialsCanBeHashTableKeys) {
+    ChainHashTable<Polynomial, std::string> chain;
+    HashTableOpenAddressing<Polynomial, std::string> open;
+    chain.insert(parsePolynomial("x+y"), "sum");
+    open.insert(parsePolynomial("x+y"), "sum");
+    EXPECT_NE(chain.find(parsePolynomial("y+x")), chain.end());
+    EXPECT_NE(open.find(parsePolynomial("y+x")), nullptr);
+    EXPECT_EQ(chain.find(parsePolynomial("x-y")), chain.end());
+}
+
+TEST(PolynomialPoolTests, EqualPolynomialsShareOneHandle) {
+    PolynomialPool pool;
+    PolynomialHandle a = pool.intern(parsePolynomial("x*y+1"));
+    Polynomial same = parsePolynomial("1+y*x");
+    PolynomialHandle b = pool.intern(same);
+    PolynomialHandle c = pool.intern(parsePolynomial("x*y-1"));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(*a, same);
+}
+
+TEST(PolynomialPoolTests, InterningComparesCoefficientsExactly) {
+    PolynomialPool pool;
+    // Коэффициенты по разные стороны границы шага квантования хеша
+    const double boundary = (0.5 + 1000.0) * HASH_COEFF_QUANTUM;
+    Polynomial below({ Monomial(boundary - 1e-10, 1, 0, 0) });
+    Polynomial above({ Monomial(boundary + 1e-10, 1, 0, 0) });
+    ASSERT_EQ(below, above);
+    PolynomialHandle a = pool.intern(below);
+    PolynomialHandle b = pool.intern(above);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.intern(Polynomial({ Monomial(boundary - 1e-10, 1, 0, 0) })), a);
+    EXPECT_EQ(pool.intern(above), b);
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(PolynomialPoolTests, CollectDropsUnreferencedPolynomials) {
+    PolynomialPool pool;
+    PolynomialHandle kept = pool.intern(parsePolynomial("z"));
+    pool.intern(parsePolynomial("x"));
+    EXPECT_EQ(pool.collect(), 1u);
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(pool.intern(parsePolynomial("z")), kept);
+}
@@ -0,0 +1,163 @@
+﻿#include "gtest.h"
+#include "PolynomialReduction.h"
+#include "TOrderedTable.h"
+#include "TAVLTree.h"
+#include "ChainHashTable.h"
+#include <vector>
+
+// Полином с count мономами подряд по ключам first, first + step, ...
+static Polynomial makeRangePolynomial(int first, int step, int count, double coeff) {
+    TermList terms;
+    for (int i = 0; i < count; ++i) {
+        terms.push_back(Monomial::fromKey(coeff, first + i * step));
+    }
+    return Polynomial(std::vector<Monomial>(terms.begin(), terms.end()));
+}
+
+static Polynomial sumPairwise(const std::vector<Polynomial>& polys) {
+    Polynomial result;
+    for (const auto& p : polys) {
+        result = result + p;
+    }
+    return result;
+}
+
+TEST(PolynomialSumTests, EmptyRangeGivesZero) {
+    std::vector<Polynomial> polys;
+    EXPECT_EQ(sum(polys), Polynomial());
+}
+
+TEST(PolynomialSumTests, MergeMatchesPairwiseAddition) {
+    std::vector<Polynomial> polys;
+    for (int i = 0; i < 10; ++i) {
+        polys.push_back(makeRangePolynomial(i, 7, 5, 1.0 + i));
+    }
+    polys.push_back(makeRangePolynomial(0, 7, 5, -1.0)); // сокращает часть мономов
+    EXPECT_EQ(sum(polys), sumPairwise(polys));
+}
+
+TEST(PolynomialSumTests, DenseAndParallelMatchPairwiseAddition) {
+    std::vector<Polynomial> polys;
+    for (int i = 0; i < 200; ++i) {
+        polys.push_back(makeRangePolynomial(i % 37, 3 + i % 5, 40, 0.5 * (i % 7) - 1.0));
+    }
+    Polynomial expected = sumPairwise(polys);
+    EXPECT_EQ(sum(polys), expected);
+    EXPECT_EQ(sum(polys.begin(), polys.end(), 4), expected);
+    ThreadPool pool(3);
+    EXPECT_EQ(sum(polys, pool), expected);
+}
+
+TEST(PolynomialSumTests, AcceptsContainerIterators) {
+    std::vector<Polynomial> polys;
+    TOrderedTable<int, Polynomial> ordered;
+    TAVLTree<int, Polynomial> avl;
+    ChainHashTable<int, Polynomial> chain;
+    for (int i = 0; i < 12; ++i) {
+        Polynomial p = makeRangePolynomial(i * 3, 11, 6, 2.0 - i);
+        polys.push_back(p);
+        ordered.insert(i, p);
+        avl.insert(i, p);
+        chain.insert(i, p);
+    }
+    Polynomial expected = sumPairwise(polys);
+    EXPECT_EQ(sum(ordered), expected);
+    EXPECT_EQ(sum(avl.begin(), avl.end()), expected);
+    EXPECT_EQ(sum(chain), expected);
+}
+
+TEST(PolynomialProductTests, EmptyRangeGivesOne) {
+    std::vector<Polynomial> polys;
+    EXPECT_EQ(product(polys), Polynomial({ Monomial(1.0, 0, 0, 0) }));
+}
+
+TEST(PolynomialProductTests, TreeMatchesLeftToRightProduct) {
+    std::vector<Polynomial> polys;
+    for (int i = 0; i < 8; ++i) {
+        polys.push_back(Polynomial({ Monomial(1.0, 1, 0, 0), Monomial(0.5 * i - 1.0, 0, i % 2, 0), Monomial(2.0, 0, 0, 1) }));
+    }
+    Polynomial expected = polys[0];
+    for (size_t i = 1; i < polys.size(); ++i) {
+        expected = expected * polys[i];
+    }
+    EXPECT_EQ(product(polys), expected);
+    EXPECT_EQ(product(polys.begin(), polys.end(), 4), expected);
+
+    ThreadPool pool(3);
+    EXPECT_EQ(product(polys, pool), expected);
+    EXPECT_EQ(product(polys.begin(), polys.begin() + 5, pool), polys[0] * polys[1] * polys[2] * polys[3] * polys[4]);
+}
+
+TEST(PolynomialProductTests, DegreeOverflowThrowsBeforeMultiplying) {
+    std::vector<Polynomial> polys(10, Polynomial({ Monomial(1.0, 1, 0, 0), Monomial(1.0, 0, 0, 0) }));
+    EXPECT_THROW(product(polys), std::out_of_range);
+    polys.pop_back();
+    EXPECT_NO_THROW(product(polys, 2));
+}
+
+TEST(PolynomialSumTests, WorksForExactCoefficients) {
+    std::vector<TPolynomial<int64_t>> polys;
+    for (int i = 0; i < 40; ++i) {
+        polys.push_back(TPolynomial<int64_t>({ TMonomial<int64_t>(i, i % 4, 0, 0), TMonomial<int64_t>(-1, 0, 0, i % 3) }));
+    }
+    TPolynomial<int64_t> expected;
+    for (const auto& p : polys) {
+        expected += p;
+    }
+    EXPECT_EQ(sum(polys, 2), expected);
+    EXPECT_EQ(product(polys.begin(), polys.begin() + 3), polys[0] * polys[1] * polys[2]);
+}
+
+TEST(PolynomialSumTests, WorksForSparseLayouts) {
+    using Poly6 = PolynomialN<6, 12>;
+    std::vector<Poly6> polys;
+    for (int i = 0; i < 40; ++i) {
+        polys.push_back(Poly6({ Poly6::Monomial(1.0 + i, { i % 7, 0, 0, 0, 0, 6 - i % 7 }), Poly6::Monomial(-1.0, { 0, 1 }) }));
+    }
+    Poly6 expected;
+    for (const auto& p : polys) {
+        expected += p;
+    }
+    EXPECT_EQ(sum(polys, 2), expected);
+    EXPECT_EQ(product(polys.begin(), polys.begin() + 2), polys[0] * polys[1]);
+}
+
+// Коэффициент, у которого считаются проверки на ноль: нормализация проверяет
+// каждый моном результата, поэтому повторная нормализация суммы их удваивает
+struct ZeroCheckCounter {
+    static int& checks() {
+        static int count = 0;
+        return count;
+    }
+
+    double value;
+    ZeroCheckCounter(double v = 0) : value(v) {}
+
+    ZeroCheckCounter& operator+=(const ZeroCheckCounter& other) { value += other.value; return *this; }
+    ZeroCheckCounter operator*(const ZeroCheckCounter& other) const { return ZeroCheckCounter(value * other.value); }
+    ZeroCheckCounter operator-() const { return ZeroCheckCounter(-value); }
+};
+
+template<>
+struct CoeffTraits<ZeroCheckCounter> {
+    static const bool exact = true;
+    static bool isZero(const ZeroCheckCounter& c) { ZeroCheckCounter::checks()++; return c.value == 0; }
+    static bool equal(const ZeroCheckCounter& a, const ZeroCheckCounter& b) { return a.value == b.value; }
+    static bool isNegative(const ZeroCheckCounter& c) { return c.value < 0; }
+    static size_t hash(const ZeroCheckCounter& c) { return std::hash<double>()(c.value); }
+};
+
+TEST(PolynomialSumTests, SumDoesNotRenormalizeResult) {
+    using CountingPoly = TPolynomial<ZeroCheckCounter>;
+    std::vector<CountingPoly> polys;
+    for (int i = 0; i < 6; ++i) {
+        polys.push_back(CountingPoly({ TMonomial<ZeroCheckCounter>(1.0 + i, i, 0, 0), TMonomial<ZeroCheckCounter>(2.0, 0, 1, 0) }));
+    }
+
+    // Слияние сразу дает канонический список: каждый моном проверен один раз
+    ZeroCheckCounter::checks() = 0;
+    CountingPoly total = sum(polys);
+    ASSERT_EQ(7u, total.getTerms().size());
+    EXPECT_EQ(7, ZeroCheckCounter::checks());
+    EXPECT_EQ(12.0, total.getTerms()[5].coeff.value); // y
+}
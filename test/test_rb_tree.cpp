@@ -4,6 +4,7 @@
 #include <algorithm> 
 #include <map>       
 #include "../include/TRB-Tree.h"
+#include "copy_counter.h"
 
 // --- Тесты для RBTree<int, int> и RBTree<std::string, int> ---
 
@@ -244,4 +245,24 @@ TEST(RBTreeGenericTest, StringKeyTest) {
 
     EXPECT_TRUE(tree.erase("banana"));
     EXPECT_EQ(tree.find("banana"), tree.end());
-}
\ No newline at end of file
+}
+
+TEST(RBTreeGenericTest, InsertRvalueDoesNotCopyValue) {
+    RBTree<int, CopyCounter> tree;
+    CopyCounter::copies() = 0;
+    for (int key = 0; key < 20; ++key) {
+        tree.insert(key, CopyCounter(key));
+    }
+    auto result = tree.insert(3, CopyCounter(33));
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(33, (*result.first).second.value);
+    EXPECT_EQ(0, CopyCounter::copies());
+
+    RBTree<int, CopyCounter> moved(std::move(tree));
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(19, (*moved.find(19)).second.value);
+
+    CopyCounter::copies() = 0;
+    moved.emplace(100, 100);
+    EXPECT_EQ(0, CopyCounter::copies());
+}
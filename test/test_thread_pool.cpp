@@ -0,0 +1,53 @@
+#include "gtest.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+#include <thread>
+
+TEST(ThreadPoolTests, RunsEveryIndexExactlyOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallelFor(hits.size(), [&hits](size_t i) { hits[i]++; });
+    for (const auto& h : hits) {
+        EXPECT_EQ(h.load(), 1);
+    }
+    pool.parallelFor(0, [](size_t) { FAIL(); });
+}
+
+TEST(ThreadPoolTests, IdleWorkersStealUnevenWork) {
+    ThreadPool pool(4);
+    std::atomic<int> done(0);
+    std::atomic<int> started(0);
+    const size_t steals_before = pool.steals();
+    // Задачи 0-3 попадают в очередь первого потока и ждут, пока все четыре не
+    // начнутся одновременно. Без перехвата эту очередь выполняют только ее
+    // владелец и вызывающий поток, поэтому минимум две задачи перехвачены.
+    pool.parallelFor(16, [&done, &started](size_t i) {
+        if (i < 4) {
+            started++;
+            while (started.load() < 4) std::this_thread::yield();
+        }
+        done++;
+    });
+    EXPECT_EQ(done.load(), 16);
+    EXPECT_GE(pool.steals() - steals_before, 2u);
+}
+
+TEST(ThreadPoolTests, NestedLoopsAndExceptions) {
+    ThreadPool pool(2);
+    std::atomic<int> total(0);
+    pool.parallelFor(4, [&pool, &total](size_t) {
+        pool.parallelFor(8, [&total](size_t) { total++; });
+    });
+    EXPECT_EQ(total.load(), 32);
+
+    EXPECT_THROW(pool.parallelFor(10, [](size_t i) {
+        if (i == 7) throw std::runtime_error("ошибка задачи");
+    }), std::runtime_error);
+    // После исключения пул продолжает работать
+    total = 0;
+    pool.parallelFor(5, [&total](size_t) { total++; });
+    EXPECT_EQ(total.load(), 5);
+}
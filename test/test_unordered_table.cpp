@@ -1,6 +1,7 @@
 ﻿#include "gtest.h"
 #include <string>
 #include "../include/TUnorderedTable.h"
+#include "copy_counter.h"
 #include <vector>
 
 
@@ -271,4 +272,20 @@ TEST(UnorderedTableTest, IteratorBehaviorAfterSwapAndPopErase) {
 
     EXPECT_EQ(table.find(2), table.end());
     EXPECT_EQ(table.size(), 3);
-}
\ No newline at end of file
+}
+
+TEST(UnorderedTableTest, InsertRvalueDoesNotCopyValue) {
+    TUnorderedTable<int, CopyCounter> table;
+    CopyCounter::copies() = 0;
+    for (int key = 0; key < 20; ++key) {
+        table.insert(key, CopyCounter(key));
+    }
+    table.insert(3, CopyCounter(33));
+    EXPECT_EQ(0, CopyCounter::copies());
+    EXPECT_EQ(20u, table.size());
+    EXPECT_EQ(33, table[3].value);
+
+    CopyCounter::copies() = 0;
+    table.emplace(100, 100);
+    EXPECT_EQ(0, CopyCounter::copies());
+}